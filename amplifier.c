@@ -17,43 +17,11 @@
 #include <gtk/gtk.h>
 
 #include "main.h"
+#include "parameters.h"
+#include "journal.h"
 #include "dialog.h"
 #include "amplifier.h"
 
-static ScaleParams env4_depth_params = {
-    .parameter = PARAMETER_DCA4_ENV4_DEPTH,
-    .multiplier = 2
-};
-
-static ScaleParams pan_params = {
-    .parameter = PARAMETER_DCA4_PAN,
-    .multiplier = 8
-};
-
-static ComboBoxEntry pan_mod_srcs[] = {
-    { "LFO 1",               PARAMETER_DCA4_MOD_SRC, 0x00 },
-    { "LFO 2",               PARAMETER_DCA4_MOD_SRC, 0x08 },
-    { "LFO 3",               PARAMETER_DCA4_MOD_SRC, 0x10 },
-    { "Envelope 1",          PARAMETER_DCA4_MOD_SRC, 0x18 },
-    { "Envelope 2",          PARAMETER_DCA4_MOD_SRC, 0x20 },
-    { "Envelope 3",          PARAMETER_DCA4_MOD_SRC, 0x28 },
-    { "Envelope 4",          PARAMETER_DCA4_MOD_SRC, 0x30 },
-    { "Velocity",            PARAMETER_DCA4_MOD_SRC, 0x38 },
-    { "Velocity X",          PARAMETER_DCA4_MOD_SRC, 0x40 },
-    { "Keyboard",            PARAMETER_DCA4_MOD_SRC, 0x48 },
-    { "Keyboard 2",          PARAMETER_DCA4_MOD_SRC, 0x50 },
-    { "Modulation Wheel",    PARAMETER_DCA4_MOD_SRC, 0x58 },
-    { "Foot Pedal",          PARAMETER_DCA4_MOD_SRC, 0x60 },
-    { "External Controller", PARAMETER_DCA4_MOD_SRC, 0x68 },
-    { "Pressure",            PARAMETER_DCA4_MOD_SRC, 0x70 },
-    { "Off",                 PARAMETER_DCA4_MOD_SRC, 0x78 }
-};
-
-static ScaleParams pan_mod_depth_params = {
-    .parameter = PARAMETER_DCA4_MOD_DEPTH,
-    .offset = 64
-};
-
 AmplifierDialog *
 new_amplifier_dialog(GtkWindow *parent)
 {
@@ -68,19 +36,19 @@ new_amplifier_dialog(GtkWindow *parent)
     grid = create_grid(GTK_CONTAINER(widgets->dialog));
 
     label = gtk_label_new("Env 4 Depth:");
-    widgets->env4_depth = create_hscale_with_params(0, 63, &env4_depth_params);
+    widgets->env4_depth = create_hscale(PARAMETER_DCA4_ENV4_DEPTH);
     create_grid_row(grid, 0, GTK_LABEL(label), GTK_WIDGET(widgets->env4_depth));
 
     label = gtk_label_new("Pan:");
-    widgets->pan = create_hscale_with_params(0, 15, &pan_params);
+    widgets->pan = create_hscale(PARAMETER_DCA4_PAN);
     create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(widgets->pan));
 
     label = gtk_label_new("Pan Mod:");
-    widgets->mod_src = create_combo_box_with_entries(pan_mod_srcs, G_N_ELEMENTS(pan_mod_srcs));
+    widgets->mod_src = create_combo_box(PARAMETER_DCA4_MOD_SRC);
     create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(widgets->mod_src));
 
     label = gtk_label_new("Pan Mod Depth:");
-    widgets->mod_depth = create_hscale_with_params(-63, 63, &pan_mod_depth_params);
+    widgets->mod_depth = create_hscale(PARAMETER_DCA4_MOD_DEPTH);
     create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(widgets->mod_depth));
 
     button_box = gtk_button_box_new(GTK_ORIENTATION_HORIZONTAL);
@@ -110,10 +78,10 @@ set_amplifier_parameters(AmplifierDialog *widgets, Patch *patch)
         patch->parameters[PARAMETER_DCA4_MOD_SRC],
         patch->parameters[PARAMETER_DCA4_MOD_DEPTH]);
 
-    gtk_range_set_value(GTK_RANGE(widgets->pan), patch->parameters[PARAMETER_DCA4_PAN]);
-    gtk_range_set_value(GTK_RANGE(widgets->env4_depth), patch->parameters[PARAMETER_DCA4_ENV4_DEPTH]);
+    gtk_range_set_value(GTK_RANGE(widgets->pan), parameters_decode(PARAMETER_DCA4_PAN, patch->parameters[PARAMETER_DCA4_PAN]));
+    gtk_range_set_value(GTK_RANGE(widgets->env4_depth), parameters_decode(PARAMETER_DCA4_ENV4_DEPTH, patch->parameters[PARAMETER_DCA4_ENV4_DEPTH]));
     gtk_combo_box_set_active(GTK_COMBO_BOX(widgets->mod_src), patch->parameters[PARAMETER_DCA4_MOD_SRC]);
-    gtk_range_set_value(GTK_RANGE(widgets->mod_depth), patch->parameters[PARAMETER_DCA4_MOD_DEPTH]);
+    gtk_range_set_value(GTK_RANGE(widgets->mod_depth), parameters_decode(PARAMETER_DCA4_MOD_DEPTH, patch->parameters[PARAMETER_DCA4_MOD_DEPTH]));
 }
 
 void
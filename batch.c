@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "patch.h"
+#include "envgen.h"
+#include "lfogen.h"
+#include "modmatrix.h"
+#include "vcf.h"
+#include "synth.h"
+#include "xmlparser.h"
+#include "batch.h"
+
+/*
+ * Each worker owns a range of items, which it processes from the front.
+ * A worker that runs out of items steals the back half of the largest
+ * range left, so a few slow items don't leave the other cores idle.
+ */
+typedef struct {
+    GMutex mutex;
+    gint next;
+    gint end;
+} BatchQueue;
+
+typedef struct {
+    BatchFunc func;
+    gpointer data;
+    BatchQueue *queues;
+    gint queue_count;
+    gint done;
+    gint failed;
+} Batch;
+
+typedef struct {
+    Batch *batch;
+    gint id;
+} BatchWorker;
+
+typedef struct {
+    GPtrArray *filenames;
+    GPtrArray *names;
+    const gchar *directory;
+    const gint *notes;
+    gint note_count;
+    gint velocity;
+    gfloat duration;
+} BatchRender;
+
+static gpointer batch_worker(gpointer);
+static gint batch_take(Batch *, gint);
+static gboolean batch_render_patch(gint, gpointer);
+static GPtrArray *batch_name_patches(GPtrArray *);
+
+/**
+   \brief Finds the patches to render, looking inside any directories for
+   files ending with ".pat".
+
+   \param paths - the patch files and directories.
+   \param count - the number of paths.
+   \param names - set to a name for the WAV file of each patch, if not NULL.
+   Patches in different directories with the same file name are given
+   different names, so no two are rendered to the same file.
+   \return an array of patch file names, which the caller must free.
+ */
+GPtrArray *
+batch_find_patches(gchar **paths, gint count, GPtrArray **names)
+{
+    GPtrArray *filenames;
+    GDir *dir;
+    const gchar *name;
+    gint i;
+
+    filenames = g_ptr_array_new_with_free_func(g_free);
+
+    for (i = 0; i < count; ++i) {
+        if (!g_file_test(paths[i], G_FILE_TEST_IS_DIR)) {
+            g_ptr_array_add(filenames, g_strdup(paths[i]));
+            continue;
+        }
+
+        if (!(dir = g_dir_open(paths[i], 0, NULL))) {
+            g_printerr("Unable to read %s\n", paths[i]);
+            continue;
+        }
+
+        while ((name = g_dir_read_name(dir))) {
+            if (g_str_has_suffix(name, ".pat")) {
+                g_ptr_array_add(filenames, g_build_filename(paths[i], name, NULL));
+            }
+        }
+
+        g_dir_close(dir);
+    }
+
+    if (names) {
+        *names = batch_name_patches(filenames);
+    }
+
+    return filenames;
+}
+
+/**
+   \brief Processes a batch of items, using a thread for each processor.
+   The items are shared out by number, and a thread that runs out steals
+   from the thread with the most left.
+
+   \param count - the number of items.
+   \param threads - the number of threads, or zero for one per processor.
+   \param func - the function that processes an item, which is called from
+   the threads with the number of the item.
+   \param data - the data to pass to the function.
+   \param result - the number of items processed and the time taken.
+ */
+void
+batch_run(gint count, gint threads, BatchFunc func, gpointer data, BatchResult *result)
+{
+    Batch batch;
+    BatchWorker *workers;
+    GThread **thread;
+    gint64 start;
+    gint i;
+
+    if (threads < 1) {
+        threads = g_get_num_processors();
+    }
+    threads = CLAMP(threads, 1, MAX(count, 1));
+
+    batch.func = func;
+    batch.data = data;
+    batch.queue_count = threads;
+    batch.queues = g_new(BatchQueue, threads);
+    batch.done = 0;
+    batch.failed = 0;
+
+    workers = g_new(BatchWorker, threads);
+    thread = g_new(GThread *, threads);
+
+    for (i = 0; i < threads; ++i) {
+        g_mutex_init(&batch.queues[i].mutex);
+        batch.queues[i].next = count * i / threads;
+        batch.queues[i].end = count * (i + 1) / threads;
+        workers[i].batch = &batch;
+        workers[i].id = i;
+    }
+
+    synth_initialise();
+
+    start = g_get_monotonic_time();
+
+    for (i = 0; i < threads; ++i) {
+        thread[i] = g_thread_new("batch", batch_worker, &workers[i]);
+    }
+
+    for (i = 0; i < threads; ++i) {
+        g_thread_join(thread[i]);
+    }
+
+    result->seconds = (g_get_monotonic_time() - start) / (gdouble) G_USEC_PER_SEC;
+    result->rendered = batch.done;
+    result->failed = batch.failed;
+
+    for (i = 0; i < threads; ++i) {
+        g_mutex_clear(&batch.queues[i].mutex);
+    }
+
+    g_free(thread);
+    g_free(workers);
+    g_free(batch.queues);
+}
+
+/**
+   \brief Renders notes played with each of a set of patches to WAV files
+   in a directory, using a thread for each processor.
+
+   \param filenames - the patch file names.
+   \param names - the names of the WAV files, from batch_find_patches().
+   \param directory - the directory to write the WAV files to.
+   \param threads - the number of threads, or zero for one per processor.
+   \param notes - the MIDI note numbers.
+   \param count - the number of notes.
+   \param velocity - the note on velocity.
+   \param duration - the time in seconds before the notes are released.
+   \param result - the number of patches rendered and the time taken.
+ */
+void
+batch_render(GPtrArray *filenames, GPtrArray *names, const gchar *directory, gint threads, const gint *notes, gint count, gint velocity, gfloat duration, BatchResult *result)
+{
+    BatchRender render;
+
+    render.filenames = filenames;
+    render.names = names;
+    render.directory = directory;
+    render.notes = notes;
+    render.note_count = count;
+    render.velocity = velocity;
+    render.duration = duration;
+
+    batch_run(filenames->len, threads, batch_render_patch, &render, result);
+}
+
+static gpointer
+batch_worker(gpointer data)
+{
+    BatchWorker *worker = data;
+    Batch *batch = worker->batch;
+    gint i;
+
+    while ((i = batch_take(batch, worker->id)) >= 0) {
+        if (batch->func(i, batch->data)) {
+            g_atomic_int_inc(&batch->done);
+        } else {
+            g_atomic_int_inc(&batch->failed);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns the index of the next item for a worker to process, or -1 when
+ * all the items have been taken. Only one queue is locked at a time.
+ */
+static gint
+batch_take(Batch *batch, gint id)
+{
+    BatchQueue *queue, *victim;
+    gint i, remaining, largest, start, end;
+
+    queue = &batch->queues[id];
+
+    g_mutex_lock(&queue->mutex);
+    i = queue->next < queue->end ? queue->next++ : -1;
+    g_mutex_unlock(&queue->mutex);
+
+    while (i < 0) {
+        /* find the queue with the most items left */
+        victim = NULL;
+        largest = 0;
+        for (i = 0; i < batch->queue_count; ++i) {
+            g_mutex_lock(&batch->queues[i].mutex);
+            remaining = batch->queues[i].end - batch->queues[i].next;
+            g_mutex_unlock(&batch->queues[i].mutex);
+            if (remaining > largest) {
+                largest = remaining;
+                victim = &batch->queues[i];
+            }
+        }
+
+        if (!victim) {
+            return -1;
+        }
+
+        g_mutex_lock(&victim->mutex);
+        end = victim->end;
+        start = victim->next + (end - victim->next) / 2;
+        if (start < end) {
+            victim->end = start;
+        }
+        g_mutex_unlock(&victim->mutex);
+
+        i = -1;
+
+        if (start < end) {
+            g_mutex_lock(&queue->mutex);
+            queue->next = start + 1;
+            queue->end = end;
+            g_mutex_unlock(&queue->mutex);
+            i = start;
+        }
+    }
+
+    return i;
+}
+
+static gboolean
+batch_render_patch(gint i, gpointer data)
+{
+    BatchRender *render = data;
+    Patch *patch;
+    GError *error = NULL;
+    const gchar *filename;
+    gchar *wav_name, *wav_filename;
+    gboolean status;
+
+    filename = g_ptr_array_index(render->filenames, i);
+
+    if (!(patch = xmlparser_read(filename, &error))) {
+        g_printerr("Unable to load %s:\n%s\n", filename, error->message);
+        g_error_free(error);
+        return FALSE;
+    }
+
+    wav_name = g_strconcat(g_ptr_array_index(render->names, i), ".wav", NULL);
+    wav_filename = g_build_filename(render->directory, wav_name, NULL);
+
+    status = synth_render(patch, render->notes, render->note_count, render->velocity, render->duration, wav_filename, &error);
+
+    if (!status) {
+        g_printerr("Unable to render %s:\n%s\n", wav_filename, error->message);
+        g_error_free(error);
+    }
+
+    g_free(wav_filename);
+    g_free(wav_name);
+
+    patch_free(patch);
+
+    return status;
+}
+
+/*
+ * Names the WAV file of each patch after the patch file, adding the number
+ * of the patch to any name already taken by a patch from another directory.
+ */
+static GPtrArray *
+batch_name_patches(GPtrArray *filenames)
+{
+    GPtrArray *names;
+    GHashTable *taken;
+    gchar *base, *name;
+    guint i, n;
+
+    names = g_ptr_array_new_with_free_func(g_free);
+    taken = g_hash_table_new(g_str_hash, g_str_equal);
+
+    for (i = 0; i < filenames->len; ++i) {
+        base = g_path_get_basename(g_ptr_array_index(filenames, i));
+        if (g_str_has_suffix(base, ".pat")) {
+            base[strlen(base) - 4] = '\0';
+        }
+
+        name = g_strdup(base);
+
+        for (n = i + 1; g_hash_table_contains(taken, name); ++n) {
+            g_free(name);
+            name = g_strdup_printf("%s-%u", base, n);
+        }
+
+        g_free(base);
+
+        g_ptr_array_add(names, name);
+        g_hash_table_add(taken, name);
+    }
+
+    g_hash_table_destroy(taken);
+
+    return names;
+}
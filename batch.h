@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+typedef struct {
+    gint rendered;
+    gint failed;
+    gdouble seconds;
+} BatchResult;
+
+/* Processes one item of a batch, returning whether it succeeded */
+typedef gboolean (*BatchFunc)(gint, gpointer);
+
+GPtrArray *batch_find_patches(gchar **, gint, GPtrArray **);
+void batch_run(gint, gint, BatchFunc, gpointer, BatchResult *);
+void batch_render(GPtrArray *, GPtrArray *, const gchar *, gint, const gint *, gint, gint, gfloat, BatchResult *);
+
+#endif /* !BATCH_H */
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "dialog.h"
+#include "duplicates.h"
+#include "collapsedialog.h"
+
+/*
+ * Removes every patch with the same parameters as a patch before it from
+ * the list, keeping the first of each set, and tells how many were closed.
+ * The removed patches are returned for the caller to forget and free.
+ */
+GPtrArray *
+run_collapse_dialog(GtkWindow *parent, GtkListStore *store)
+{
+    GtkWidget *dialog;
+    GtkTreeIter iter;
+    GPtrArray *removed;
+    DuplicateIndex *kept;
+    Patch *patch;
+    gboolean valid;
+
+    removed = g_ptr_array_new();
+
+    kept = duplicates_new();
+
+    valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(store), &iter);
+
+    while (valid) {
+        gtk_tree_model_get(GTK_TREE_MODEL(store), &iter, DATA_COL, &patch, -1);
+
+        if (duplicates_add(kept, patch, NULL) == DUPLICATE_EXACT) {
+            duplicates_remove(kept, patch);
+
+            valid = gtk_list_store_remove(store, &iter);
+
+            g_ptr_array_add(removed, patch);
+        } else {
+            valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(store), &iter);
+        }
+    }
+
+    duplicates_free(kept);
+
+    dialog = gtk_message_dialog_new(parent,
+        GTK_DIALOG_MODAL,
+        GTK_MESSAGE_INFO,
+        GTK_BUTTONS_CLOSE,
+        "Closed %u duplicate patches", removed->len);
+    gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
+
+    return removed;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "parameters.h"
+#include "journal.h"
+#include "compare.h"
+
+static void find_differences(Compare *);
+
+/**
+   \brief Clears both snapshots of an A/B comparison.
+
+   \param compare - the comparison.
+ */
+void
+compare_init(Compare *compare)
+{
+    compare->patch = NULL;
+    compare->stored[COMPARE_A] = FALSE;
+    compare->stored[COMPARE_B] = FALSE;
+    compare->side = COMPARE_A;
+    compare->differing_count = 0;
+}
+
+/**
+   \brief Stores the parameters of a patch as one side of an A/B comparison,
+   and works out which parameters differ from the other side and what is
+   sent for each, so switching sides costs nothing more. Storing a
+   different patch clears the other side.
+
+   \param compare - the comparison.
+   \param side - the side to store.
+   \param patch - the patch.
+ */
+void
+compare_store(Compare *compare, CompareSide side, Patch *patch)
+{
+    if (compare->patch != patch) {
+        compare_init(compare);
+        compare->patch = patch;
+    }
+
+    memcpy(compare->snapshots[side], patch->parameters, PARAMETER_COUNT);
+    compare->stored[side] = TRUE;
+    compare->side = side;
+
+    find_differences(compare);
+}
+
+/**
+   \brief Checks whether both sides of an A/B comparison of a patch have
+   been stored.
+
+   \param compare - the comparison.
+   \param patch - the patch.
+   \return whether the sides can be switched.
+ */
+gboolean
+compare_ready(Compare *compare, Patch *patch)
+{
+    return patch && compare->patch == patch && compare->stored[COMPARE_A] && compare->stored[COMPARE_B];
+}
+
+/**
+   \brief Switches a patch to the other side of its A/B comparison. Edits
+   made since the last switch are kept in the side being left. The switch
+   is recorded in a journal as one edit, so it can be undone.
+
+   \param compare - the comparison, whose differing parameters and encoded
+   values for the new side are to be transmitted.
+   \param journal - the journal.
+   \return the number of differing parameters.
+ */
+gint
+compare_switch(Compare *compare, Journal *journal)
+{
+    Patch *patch = compare->patch;
+    const guchar *values;
+    gint i, parameter;
+
+    if (memcmp(patch->parameters, compare->snapshots[compare->side], PARAMETER_COUNT) != 0) {
+        compare_store(compare, compare->side, patch);
+    }
+
+    compare->side = compare->side == COMPARE_A ? COMPARE_B : COMPARE_A;
+
+    values = compare->snapshots[compare->side];
+
+    journal_begin_group(journal);
+    for (i = 0; i < compare->differing_count; ++i) {
+        parameter = compare->differing[i];
+        journal_record(journal, patch, parameter, patch->parameters[parameter], values[parameter]);
+    }
+    journal_end_group(journal);
+
+    memcpy(patch->parameters, values, PARAMETER_COUNT);
+
+    return compare->differing_count;
+}
+
+/*
+ * Lists the parameters that differ between the sides, along with the value
+ * each side sends for them.
+ */
+static void
+find_differences(Compare *compare)
+{
+    guchar a[PARAMETER_COUNT], b[PARAMETER_COUNT];
+    gint i, n;
+
+    compare->differing_count = 0;
+
+    if (!compare->stored[COMPARE_A] || !compare->stored[COMPARE_B]) {
+        return;
+    }
+
+    parameters_encode_all(compare->snapshots[COMPARE_A], a);
+    parameters_encode_all(compare->snapshots[COMPARE_B], b);
+
+    for (n = 0, i = 0; i < PARAMETER_COUNT; ++i) {
+        if (a[i] != b[i]) {
+            compare->differing[n] = i;
+            compare->encoded[COMPARE_A][n] = a[i];
+            compare->encoded[COMPARE_B][n] = b[i];
+            ++n;
+        }
+    }
+
+    compare->differing_count = n;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef COMPARE_H
+#define COMPARE_H
+
+typedef enum {
+    COMPARE_A,
+    COMPARE_B
+} CompareSide;
+
+typedef struct {
+    Patch *patch;
+    guchar snapshots[2][PARAMETER_COUNT];
+    gboolean stored[2];
+    CompareSide side;
+    guchar differing[PARAMETER_COUNT];
+    guchar encoded[2][PARAMETER_COUNT];
+    gint differing_count;
+} Compare;
+
+void compare_init(Compare *);
+void compare_store(Compare *, CompareSide, Patch *);
+gboolean compare_ready(Compare *, Patch *);
+gint compare_switch(Compare *, Journal *);
+
+#endif /* !COMPARE_H */
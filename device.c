@@ -18,6 +18,7 @@
 
 #include "midi.h"
 #include "main.h"
+#include "journal.h"
 #include "dialog.h"
 #include "device.h"
 
@@ -35,6 +36,7 @@ typedef struct {
     GtkWidget *program_number;
     GtkWidget *note;
     GtkWidget *velocity;
+    GtkWidget *transmit_rate;
     GtkWidget *on_button;
     GtkWidget *off_button;
     GtkWidget *close_button;
@@ -43,6 +45,7 @@ typedef struct {
 static GtkWidget *device_combo_box(void);
 static GtkWidget *program_bank_combo_box(void);
 static void device_callback(GtkWidget *, gpointer);
+static void transmit_rate_callback(GtkWidget *, gpointer);
 static void note_on_callback(GtkWidget *, gpointer);
 static void note_off_callback(GtkWidget *, gpointer);
 
@@ -87,10 +90,16 @@ device_dialog(GtkWindow *window, Statusbar *statusbar)
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(widgets->velocity), 64.0);
         create_grid_row(grid, 5, GTK_LABEL(label), widgets->velocity);
 
+        label = gtk_label_new("Updates per second:");
+        widgets->transmit_rate = gtk_spin_button_new_with_range(1.0, 100.0, 1.0);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(widgets->transmit_rate), DEFAULT_TRANSMIT_RATE);
+        g_signal_connect(G_OBJECT(widgets->transmit_rate), "value-changed", G_CALLBACK(transmit_rate_callback), NULL);
+        create_grid_row(grid, 6, GTK_LABEL(label), widgets->transmit_rate);
+
         button_box = gtk_button_box_new(GTK_ORIENTATION_HORIZONTAL);
         gtk_box_set_spacing(GTK_BOX(button_box), 6);
         gtk_button_box_set_layout(GTK_BUTTON_BOX(button_box), GTK_BUTTONBOX_END);
-        gtk_grid_attach(grid, button_box, 0, 6, 2, 1);
+        gtk_grid_attach(grid, button_box, 0, 7, 2, 1);
 
         widgets->on_button = gtk_button_new_with_label("Note On");
         g_signal_connect(G_OBJECT(widgets->on_button), "clicked", G_CALLBACK(note_on_callback), widgets);
@@ -192,6 +201,12 @@ device_callback(GtkWidget *widget, gpointer data)
     }
 }
 
+static void
+transmit_rate_callback(GtkWidget *widget, gpointer data)
+{
+    set_transmit_rate(gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(widget)));
+}
+
 static void
 note_on_callback(GtkWidget *widget, gpointer data)
 {
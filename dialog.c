@@ -18,8 +18,37 @@
 
 #include "midi.h"
 #include "main.h"
+#include "parameters.h"
+#include "journal.h"
 #include "dialog.h"
+#include "preview.h"
 
+/* Tree models shared between combo boxes, keyed by their labels */
+static GHashTable *combo_box_models = NULL;
+
+/*
+ * Most parameter changes a 31250 baud MIDI link carries per second, as each
+ * is three controller messages of three bytes
+ */
+#define LINK_PARAMETER_RATE 340
+
+/* Parameter values waiting to be transmitted on the next tick */
+static gint pending_values[PARAMETER_COUNT];
+static gboolean pending[PARAMETER_COUNT];
+static guint transmit_rate = DEFAULT_TRANSMIT_RATE;
+static guint transmit_source = 0;
+static gint transmit_cursor = 0;
+
+/* Journal that edits made with the widgets are recorded in */
+static Journal *journal = NULL;
+
+/* Whether the widgets are being set from a patch rather than by the user */
+static gboolean updating = FALSE;
+
+static gboolean transmit_callback(gpointer);
+static void transmit_parameter(gint, gint);
+static void edit_parameter(gint, guchar);
+static GtkTreeModel *get_labels_model(const gchar *const *, gint);
 static gboolean delete_window_callback(GtkWidget *, GdkEvent *, gpointer);
 
 /**
@@ -106,74 +135,48 @@ create_grid_row(GtkGrid *grid, gint row, GtkLabel *label, GtkWidget *widget)
 }
 
 /**
-   \brief Creates a horizontal scale widget to edit a patch parameter.
+   \brief Creates a horizontal scale widget to edit a patch parameter, with
+   the range given by the parameter's descriptor.
 
-   \param minimum - the minumum value of the patch parameter.
-   \param maximum - the maximum value of the patch parameter.
    \param parameter - the patch parameter.
    \return the newly created horizontal scale widget.
  */
 GtkScale *
-create_hscale(gint minimum, gint maximum, gint parameter)
+create_hscale(gint parameter)
 {
+    const ParameterDescriptor *descriptor;
     GtkWidget *hscale;
 
-    hscale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, minimum, maximum, 1);
-    gtk_widget_set_hexpand(hscale, TRUE);
-    gtk_widget_set_halign(hscale, GTK_ALIGN_FILL);
-    g_signal_connect(G_OBJECT(hscale), "button-release-event", G_CALLBACK(hscale_callback), GINT_TO_POINTER(parameter));
-    g_signal_connect(G_OBJECT(hscale), "key-release-event", G_CALLBACK(hscale_callback), GINT_TO_POINTER(parameter));
-
-    return GTK_SCALE(hscale);
-}
-
-/**
-   \brief Creates a horizontal scale widget to edit a patch parameter.
-
-   \param minimum - the minumum value of the patch parameter.
-   \param maximum - the maximum value of the patch parameter.
-   \param params - the patch parameters.
-   \return the newly created horizontal scale widget.
- */
-GtkScale *
-create_hscale_with_params(gint minimum, gint maximum, ScaleParams *params)
-{
-    GtkWidget *hscale;
+    descriptor = &parameter_descriptors[parameter];
 
-    hscale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, minimum, maximum, 1);
+    hscale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, descriptor->minimum, descriptor->maximum, 1);
     gtk_widget_set_hexpand(hscale, TRUE);
     gtk_widget_set_halign(hscale, GTK_ALIGN_FILL);
-    g_signal_connect(G_OBJECT(hscale), "button-release-event", G_CALLBACK(hscale_callback_with_params), params);
-    g_signal_connect(G_OBJECT(hscale), "key-release-event", G_CALLBACK(hscale_callback_with_params), params);
+    g_signal_connect(G_OBJECT(hscale), "value-changed", G_CALLBACK(hscale_callback), GINT_TO_POINTER(parameter));
 
     return GTK_SCALE(hscale);
 }
 
 /**
-   \brief Creates a combo box widget to edit a patch parameter.
+   \brief Creates a combo box widget to edit a patch parameter, with the
+   labels given by the parameter's descriptor.
+
+   The tree model is built once per array of labels and shared by every
+   combo box whose parameter has the same labels.
 
-   \param entries - the array of strings to populate the combo box with.
-   \param entry_count - the length of the array of strings.
    \param parameter - the patch parameter.
    \return the newly created combo box widget.
  */
 GtkComboBox *
-create_combo_box(gchar *entries[], gint entry_count, gint parameter)
+create_combo_box(gint parameter)
 {
-    gint i;
-    GtkListStore *store;
-    GtkTreeIter iter;
+    const ParameterDescriptor *descriptor;
     GtkWidget *combo_box;
     GtkCellRenderer *renderer;
 
-    store = gtk_list_store_new(1, G_TYPE_STRING);
-
-    for (i = 0; i < entry_count; ++i) {
-        gtk_list_store_append(store, &iter);
-        gtk_list_store_set(store, &iter, 0, entries[i], -1);
-    }
+    descriptor = &parameter_descriptors[parameter];
 
-    combo_box = gtk_combo_box_new_with_model(GTK_TREE_MODEL(store));
+    combo_box = gtk_combo_box_new_with_model(get_labels_model(descriptor->labels, descriptor->maximum + 1));
     g_signal_connect(G_OBJECT(combo_box), "changed", G_CALLBACK(combo_box_callback), GINT_TO_POINTER(parameter));
 
     renderer = gtk_cell_renderer_text_new();
@@ -183,39 +186,6 @@ create_combo_box(gchar *entries[], gint entry_count, gint parameter)
     return GTK_COMBO_BOX(combo_box);
 }
 
-/**
-   \brief Creates a combo box widget to edit a patch parameter.
-
-   \param entries - the array of entries to populate the combo box with.
-   \param entry_count - the length of the array of entries.
-   \return the newly created combo box widget.
- */
-GtkComboBox *
-create_combo_box_with_entries(ComboBoxEntry *entries, gint entry_count)
-{
-    gint i;
-    GtkListStore *store;
-    GtkTreeIter iter;
-    GtkWidget *combo_box;
-    GtkCellRenderer *renderer;
-
-    store = gtk_list_store_new(1, G_TYPE_STRING);
-
-    for (i = 0; i < entry_count; ++i) {
-        gtk_list_store_append(store, &iter);
-        gtk_list_store_set(store, &iter, 0, entries[i].label, -1);
-    }
-
-    combo_box = gtk_combo_box_new_with_model(GTK_TREE_MODEL(store));
-    g_signal_connect(G_OBJECT(combo_box), "changed", G_CALLBACK(combo_box_with_entries_callback), entries);
-
-    renderer = gtk_cell_renderer_text_new();
-    gtk_cell_layout_pack_start(GTK_CELL_LAYOUT(combo_box), renderer, TRUE);
-    gtk_cell_layout_set_attributes(GTK_CELL_LAYOUT(combo_box), renderer, "text", 0, NULL);
-
-    return GTK_COMBO_BOX(combo_box);
-}
-
 /**
    \brief Creates a check button widget to edit a patch parameter.
 
@@ -234,93 +204,89 @@ create_check_button(gint parameter)
 }
 
 /**
-   \brief Callback for a horizontal scale widget to edit a patch parameter.
+   \brief Sets the maximum number of parameter updates transmitted per second
+   while a scale is being dragged.
 
-   \param widget - the horizontal scale widget.
-   \param event - the event that triggered the callback.
-   \param data - the data associated with the callback.
-   \return whether to stop other handlers from being invoked for the event.
+   \param rate - the maximum number of updates per second.
  */
-gboolean
-hscale_callback(GtkWidget *widget, GdkEvent *event, gpointer data)
+void
+set_transmit_rate(guint rate)
 {
-    gint parameter, value;
-    MIDIMessage msg[3];
-
-    parameter = GPOINTER_TO_INT(data);
-
-    value = gtk_range_get_value(GTK_RANGE(widget));
-
-    fprintf(stderr, "Parameter %d value %d\n", parameter, value);
+    transmit_rate = CLAMP(rate, 1, 1000);
 
-    if (current_patch) {
-        current_patch->parameters[parameter] = (guchar) value;
+    if (transmit_source) {
+        g_source_remove(transmit_source);
+        transmit_source = g_timeout_add(1000 / transmit_rate, transmit_callback, NULL);
     }
+}
 
-    msg[0].status = 0xb0;
-    msg[0].data1 = 0x62;
-    msg[0].data2 = (guchar) parameter;
+/**
+   \brief Sets the journal that edits made with the widgets are recorded in.
 
-    msg[1].status = 0xb0;
-    msg[1].data1 = 0x63;
-    msg[1].data2 = 0x00;
+   \param edit_journal - the journal, or NULL to stop recording edits.
+ */
+void
+set_journal(Journal *edit_journal)
+{
+    journal = edit_journal;
+}
 
-    msg[2].status = 0xb0;
-    msg[2].data1 = 0x06;
-    msg[2].data2 = (guchar) value;
+/**
+   \brief Sets whether the widgets are being set from a patch. While they
+   are, their changes are neither recorded nor transmitted, as the patch
+   already holds the values and whoever set them sends what the synth needs.
 
-    midi_write(msg, 3);
+   \param widgets_updating - whether the widgets are being set.
+ */
+void
+set_updating(gboolean widgets_updating)
+{
+    updating = widgets_updating;
+}
+
+/**
+   \brief Queues a parameter value for transmission. If the link is idle the
+   value is sent straight away, otherwise it replaces any value still waiting
+   for the next tick, so at most one message per parameter is sent per tick.
 
-    return FALSE;
+   \param parameter - the patch parameter.
+   \param value - the value to transmit, as sent in the NRPN data entry.
+ */
+void
+queue_parameter(gint parameter, gint value)
+{
+    if (transmit_source == 0) {
+        transmit_parameter(parameter, value);
+        transmit_source = g_timeout_add(1000 / transmit_rate, transmit_callback, NULL);
+    } else {
+        pending_values[parameter] = value;
+        pending[parameter] = TRUE;
+    }
 }
 
 /**
    \brief Callback for a horizontal scale widget to edit a patch parameter.
 
    \param widget - the horizontal scale widget.
-   \param event - the event that triggered the callback.
    \param data - the data associated with the callback.
-   \return whether to stop other handlers from being invoked for the event.
  */
-gboolean
-hscale_callback_with_params(GtkWidget *widget, GdkEvent *event, gpointer data)
+void
+hscale_callback(GtkWidget *widget, gpointer data)
 {
-    gint parameter, value;
-    MIDIMessage msg[3];
-
-    ScaleParams *params = (ScaleParams *) data;
-
-    parameter = params->parameter;
-
-    value = gtk_range_get_value(GTK_RANGE(widget));
-
-    fprintf(stderr, "Parameter %d value %d\n", parameter, value);
-
-    if (current_patch) {
-        current_patch->parameters[parameter] = (guchar) value;
-    }
-
-    value += params->offset;
+    gint parameter;
+    guchar value;
 
-    if (params->multiplier > 0) {
-        value *= params->multiplier;
+    if (updating) {
+        return;
     }
 
-    msg[0].status = 0xb0;
-    msg[0].data1 = 0x62;
-    msg[0].data2 = (guchar) parameter;
-
-    msg[1].status = 0xb0;
-    msg[1].data1 = 0x63;
-    msg[1].data2 = 0x00;
+    parameter = GPOINTER_TO_INT(data);
 
-    msg[2].status = 0xb0;
-    msg[2].data1 = 0x06;
-    msg[2].data2 = (guchar) value;
+    value = parameters_clamp(parameter, gtk_range_get_value(GTK_RANGE(widget)));
 
-    midi_write(msg, 3);
+    edit_parameter(parameter, value);
 
-    return FALSE;
+    queue_parameter(parameter, parameters_encode(parameter, value));
 }
 
 /**
@@ -332,101 +298,117 @@ hscale_callback_with_params(GtkWidget *widget, GdkEvent *event, gpointer data)
 void
 combo_box_callback(GtkWidget *widget, gpointer data)
 {
-    gint parameter, value;
-    MIDIMessage msg[3];
+    gint parameter, i;
 
-    parameter = GPOINTER_TO_INT(data);
+    if (updating) {
+        return;
+    }
 
-    value = gtk_combo_box_get_active(GTK_COMBO_BOX(widget));
+    parameter = GPOINTER_TO_INT(data);
 
-    fprintf(stderr, "Parameter %d value %d\n", parameter, value);
+    i = gtk_combo_box_get_active(GTK_COMBO_BOX(widget));
 
-    if (current_patch) {
-        current_patch->parameters[parameter] = (guchar) value;
+    if (i < 0) {
+        return;
     }
 
-    msg[0].status = 0xb0;
-    msg[0].data1 = 0x62;
-    msg[0].data2 = (guchar) parameter;
-
-    msg[1].status = 0xb0;
-    msg[1].data1 = 0x63;
-    msg[1].data2 = 0x00;
+    edit_parameter(parameter, (guchar) i);
 
-    msg[2].status = 0xb0;
-    msg[2].data1 = 0x06;
-    msg[2].data2 = (guchar) value;
-
-    midi_write(msg, 3);
+    queue_parameter(parameter, parameters_encode(parameter, (guchar) i));
 }
 
 /**
-   \brief Callback for a combo box widget to edit a patch parameter.
+   \brief Callback for a check button widget to edit a patch parameter.
 
-   \param widget - the combo box widget.
+   \param widget - the check button widget.
    \param data - the data associated with the callback.
  */
 void
-combo_box_with_entries_callback(GtkWidget *widget, gpointer data)
+check_button_callback(GtkWidget *widget, gpointer data)
 {
-    gint parameter, value, i;
-    MIDIMessage msg[3];
-
-    ComboBoxEntry *entry = (ComboBoxEntry *) data;
-
-    i = gtk_combo_box_get_active(GTK_COMBO_BOX(widget));
-
-    parameter = entry[i].parameter;
+    gint parameter;
+    guchar value;
 
-    value = entry[i].value;
+    if (updating) {
+        return;
+    }
 
-    fprintf(stderr, "Parameter %d value %d\n", parameter, value);
+    parameter = GPOINTER_TO_INT(data);
 
-    if (current_patch) {
-        current_patch->parameters[parameter] = (guchar) value;
-    }
+    value = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget)) ? 1 : 0;
 
-    msg[0].status = 0xb0;
-    msg[0].data1 = 0x62;
-    msg[0].data2 = (guchar) parameter;
+    edit_parameter(parameter, value);
 
-    msg[1].status = 0xb0;
-    msg[1].data1 = 0x63;
-    msg[1].data2 = 0x00;
+    queue_parameter(parameter, parameters_encode(parameter, value));
+}
 
-    msg[2].status = 0xb0;
-    msg[2].data1 = 0x06;
-    msg[2].data2 = (guchar) value;
+/**
+   \brief Callback to popdown a window.
 
-    midi_write(msg, 3);
+   \param widget - the widget that activated the callback.
+   \param data - callback data (the window to popdown).
+ */
+void
+close_window_callback(GtkWidget *widget, gpointer data)
+{
+    gtk_widget_hide(GTK_WIDGET(data));
 }
 
 /**
-   \brief Callback for a check button widget to edit a patch parameter.
+   \brief Callback to accept a dialog when a row of a list in it is activated.
 
-   \param widget - the check button widget.
-   \param data - the data associated with the callback.
+   \param tree_view - the list the row is in.
+   \param path - the path of the row.
+   \param column - the column that was activated.
+   \param data - callback data (the dialog to accept).
  */
 void
-check_button_callback(GtkWidget *widget, gpointer data)
+activate_row_callback(GtkTreeView *tree_view, GtkTreePath *path, GtkTreeViewColumn *column, gpointer data)
 {
-    gint parameter;
-    gboolean value;
-    MIDIMessage msg[3];
+    gtk_dialog_response(GTK_DIALOG(data), GTK_RESPONSE_ACCEPT);
+}
 
-    parameter = GPOINTER_TO_INT(data);
+/*
+ * Transmits the values waiting for this tick, up to the share of the link's
+ * capacity that a tick allows. Sending resumes where the last tick left off,
+ * so when many parameters change at once, as in a morph, none are starved.
+ */
+static gboolean
+transmit_callback(gpointer data)
+{
+    gint i, n, budget;
+    gboolean sent = FALSE;
 
-    value = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
+    budget = MAX(1, LINK_PARAMETER_RATE / (gint) transmit_rate);
 
-    fprintf(stderr, "Parameter %d value %d\n", parameter, value ? 1 : 0);
+    for (n = 0; n < PARAMETER_COUNT && budget > 0; ++n) {
+        i = transmit_cursor;
+        transmit_cursor = (transmit_cursor + 1) % PARAMETER_COUNT;
 
-    if (current_patch) {
-        current_patch->parameters[parameter] = value ? 1 : 0;
+        if (pending[i]) {
+            pending[i] = FALSE;
+            transmit_parameter(i, pending_values[i]);
+            sent = TRUE;
+            --budget;
+        }
     }
 
+    if (!sent) {
+        transmit_source = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+transmit_parameter(gint parameter, gint value)
+{
+    MIDIMessage msg[3];
+
     msg[0].status = 0xb0;
     msg[0].data1 = 0x62;
-    msg[0].data2 = (guchar) parameter;
+    msg[0].data2 = parameter_descriptors[parameter].nrpn;
 
     msg[1].status = 0xb0;
     msg[1].data1 = 0x63;
@@ -434,21 +416,52 @@ check_button_callback(GtkWidget *widget, gpointer data)
 
     msg[2].status = 0xb0;
     msg[2].data1 = 0x06;
-    msg[2].data2 = value ? 0x40 : 0x00;
+    msg[2].data2 = (guchar) value;
 
     midi_write(msg, 3);
 }
 
-/**
-   \brief Callback to popdown a window.
-
-   \param widget - the widget that activated the callback.
-   \param data - callback data (the window to popdown).
+/*
+ * Sets a parameter of the current patch, recording the edit when the value
+ * changes.
  */
-void
-close_window_callback(GtkWidget *widget, gpointer data)
+static void
+edit_parameter(gint parameter, guchar value)
 {
-    gtk_widget_hide(GTK_WIDGET(data));
+    if (current_patch == NULL) {
+        return;
+    }
+
+    if (journal && current_patch->parameters[parameter] != value) {
+        journal_record(journal, current_patch, parameter, current_patch->parameters[parameter], value);
+    }
+
+    current_patch->parameters[parameter] = value;
+    preview_set_parameters(current_patch->parameters);
+}
+
+static GtkTreeModel *
+get_labels_model(const gchar *const *labels, gint label_count)
+{
+    gint i;
+    GtkListStore *store;
+    GtkTreeIter iter;
+
+    if (combo_box_models == NULL) {
+        combo_box_models = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+
+    if ((store = g_hash_table_lookup(combo_box_models, labels)) == NULL) {
+        store = gtk_list_store_new(1, G_TYPE_STRING);
+
+        for (i = 0; i < label_count; ++i) {
+            gtk_list_store_insert_with_values(store, &iter, -1, 0, labels[i], -1);
+        }
+
+        g_hash_table_insert(combo_box_models, (gpointer) labels, store);
+    }
+
+    return GTK_TREE_MODEL(store);
 }
 
 static gboolean
@@ -17,34 +17,34 @@
 #ifndef DIALOG_H
 #define DIALOG_H
 
-typedef struct {
-    guchar parameter;
-    gint multiplier;
-    gint offset;
-} ScaleParams;
-
-typedef struct {
-    gchar *label;
-    guchar parameter;
-    guchar value;
-} ComboBoxEntry;
+/* Default maximum parameter updates per second while dragging a scale */
+#define DEFAULT_TRANSMIT_RATE 25
+
+/* Columns of the list of patches in the main window */
+enum { NAME_COL, TYPE_COL, DATA_COL, NCOLS };
 
 GtkWindow *create_window(GtkWindow *, const gchar *, gboolean);
 void show_window(GtkWindow *);
 GtkGrid *create_grid(GtkContainer *);
 void create_grid_row(GtkGrid *, gint, GtkLabel *, GtkWidget *);
 
-GtkScale *create_hscale(gint, gint, gint);
-GtkScale *create_hscale_with_params(gint, gint, ScaleParams *);
-GtkComboBox *create_combo_box(gchar **, gint, gint);
-GtkComboBox *create_combo_box_with_entries(ComboBoxEntry *, gint);
+GtkScale *create_hscale(gint);
+GtkComboBox *create_combo_box(gint);
 GtkCheckButton *create_check_button(gint);
 
-gboolean hscale_callback(GtkWidget *, GdkEvent *, gpointer);
-gboolean hscale_callback_with_params(GtkWidget *, GdkEvent *, gpointer);
+void set_transmit_rate(guint);
+void set_updating(gboolean);
+void queue_parameter(gint, gint);
+
+/* only declared for the modules that include the journal */
+#ifdef JOURNAL_H
+void set_journal(Journal *);
+#endif
+
+void hscale_callback(GtkWidget *, gpointer);
 void combo_box_callback(GtkWidget *, gpointer);
-void combo_box_with_entries_callback(GtkWidget *, gpointer);
 void check_button_callback(GtkWidget *, gpointer);
 void close_window_callback(GtkWidget *, gpointer);
+void activate_row_callback(GtkTreeView *, GtkTreePath *, GtkTreeViewColumn *, gpointer);
 
 #endif /* !DIALOG_H */
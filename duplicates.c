@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "similar.h"
+#include "duplicates.h"
+
+/* Parameters of the 64 bit FNV-1a hash */
+#define FNV_OFFSET_BASIS G_GUINT64_CONSTANT(0xcbf29ce484222325)
+#define FNV_PRIME G_GUINT64_CONSTANT(0x100000001b3)
+
+typedef struct {
+    guint64 exact;
+    guint64 near;
+} Hashes;
+
+typedef struct {
+    guint64 hash;
+    GSList *patches;
+} Bucket;
+
+static void bucket_add(GHashTable *, guint64, Patch *);
+static void bucket_remove(GHashTable *, guint64, Patch *);
+static void bucket_free(gpointer);
+
+/**
+   \brief Calculates a 64 bit hash of a block of bytes, such as the
+   parameters of a patch.
+
+   \param data - the bytes to hash.
+   \param length - the number of bytes.
+   \return the hash.
+ */
+guint64
+duplicates_hash(const guchar *data, gsize length)
+{
+    guint64 hash;
+    gsize i;
+
+    hash = FNV_OFFSET_BASIS;
+
+    for (i = 0; i < length; ++i) {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+   \brief Creates an empty index of the patches in a library, keyed by the
+   hashes of their parameters.
+
+   \return the index.
+ */
+DuplicateIndex *
+duplicates_new(void)
+{
+    DuplicateIndex *index;
+
+    index = g_new(DuplicateIndex, 1);
+    index->patches = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    index->exact = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, bucket_free);
+    index->near = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, bucket_free);
+
+    return index;
+}
+
+/**
+   \brief Frees an index of patches. The patches themselves aren't freed.
+
+   \param index - the index to free.
+ */
+void
+duplicates_free(DuplicateIndex *index)
+{
+    g_hash_table_destroy(index->patches);
+    g_hash_table_destroy(index->exact);
+    g_hash_table_destroy(index->near);
+    g_free(index);
+}
+
+/**
+   \brief Adds a patch to an index, or updates it if its parameters have
+   changed since it was added, and finds whether the index holds a patch
+   with the same or nearly the same parameters.
+
+   \param index - the index.
+   \param patch - the patch to add.
+   \param original - set to the patch it duplicates, if not NULL.
+   \return whether the patch is an exact or near duplicate.
+ */
+DuplicateKind
+duplicates_add(DuplicateIndex *index, Patch *patch, Patch **original)
+{
+    Hashes *hashes;
+    Bucket *bucket;
+    GSList *list;
+    Patch *other;
+    DuplicateKind kind;
+    guchar coarse[PARAMETER_COUNT], other_coarse[PARAMETER_COUNT];
+
+    duplicates_remove(index, patch);
+
+    hashes = g_new(Hashes, 1);
+    hashes->exact = duplicates_hash(patch->parameters, PARAMETER_COUNT);
+    similar_coarsen(patch->parameters, coarse);
+    hashes->near = duplicates_hash(coarse, PARAMETER_COUNT);
+
+    kind = DUPLICATE_NONE;
+    other = NULL;
+
+    if ((bucket = g_hash_table_lookup(index->exact, &hashes->exact))) {
+        /* compare the parameters, in case different ones share a hash */
+        for (list = bucket->patches; list; list = list->next) {
+            if (memcmp(((Patch *) list->data)->parameters, patch->parameters, PARAMETER_COUNT) == 0) {
+                kind = DUPLICATE_EXACT;
+                other = list->data;
+                break;
+            }
+        }
+    }
+
+    if (kind == DUPLICATE_NONE && (bucket = g_hash_table_lookup(index->near, &hashes->near))) {
+        /* likewise compare the coarsened parameters of each patch in the bucket */
+        for (list = bucket->patches; list; list = list->next) {
+            similar_coarsen(((Patch *) list->data)->parameters, other_coarse);
+            if (memcmp(other_coarse, coarse, PARAMETER_COUNT) == 0) {
+                kind = DUPLICATE_NEAR;
+                other = list->data;
+                break;
+            }
+        }
+    }
+
+    bucket_add(index->exact, hashes->exact, patch);
+    bucket_add(index->near, hashes->near, patch);
+    g_hash_table_insert(index->patches, patch, hashes);
+
+    if (original) {
+        *original = other;
+    }
+
+    return kind;
+}
+
+/**
+   \brief Removes a patch from an index.
+
+   \param index - the index.
+   \param patch - the patch to remove.
+ */
+void
+duplicates_remove(DuplicateIndex *index, Patch *patch)
+{
+    Hashes *hashes;
+
+    if ((hashes = g_hash_table_lookup(index->patches, patch))) {
+        bucket_remove(index->exact, hashes->exact, patch);
+        bucket_remove(index->near, hashes->near, patch);
+        g_hash_table_remove(index->patches, patch);
+    }
+}
+
+static void
+bucket_add(GHashTable *table, guint64 hash, Patch *patch)
+{
+    Bucket *bucket;
+
+    if (!(bucket = g_hash_table_lookup(table, &hash))) {
+        bucket = g_new(Bucket, 1);
+        bucket->hash = hash;
+        bucket->patches = NULL;
+        g_hash_table_insert(table, &bucket->hash, bucket);
+    }
+
+    bucket->patches = g_slist_prepend(bucket->patches, patch);
+}
+
+static void
+bucket_remove(GHashTable *table, guint64 hash, Patch *patch)
+{
+    Bucket *bucket;
+
+    if ((bucket = g_hash_table_lookup(table, &hash))) {
+        bucket->patches = g_slist_remove(bucket->patches, patch);
+
+        if (!bucket->patches) {
+            g_hash_table_remove(table, &hash);
+        }
+    }
+}
+
+static void
+bucket_free(gpointer data)
+{
+    Bucket *bucket = data;
+
+    g_slist_free(bucket->patches);
+    g_free(bucket);
+}
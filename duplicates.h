@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DUPLICATES_H
+#define DUPLICATES_H
+
+typedef enum {
+    DUPLICATE_NONE,
+    DUPLICATE_NEAR,
+    DUPLICATE_EXACT
+} DuplicateKind;
+
+typedef struct {
+    GHashTable *patches;
+    GHashTable *exact;
+    GHashTable *near;
+} DuplicateIndex;
+
+guint64 duplicates_hash(const guchar *, gsize);
+
+DuplicateIndex *duplicates_new(void);
+void duplicates_free(DuplicateIndex *);
+DuplicateKind duplicates_add(DuplicateIndex *, Patch *, Patch **);
+void duplicates_remove(DuplicateIndex *, Patch *);
+
+#endif /* !DUPLICATES_H */
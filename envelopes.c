@@ -14,179 +14,26 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <math.h>
+
 #include <gtk/gtk.h>
 
 #include "main.h"
+#include "parameters.h"
+#include "journal.h"
 #include "dialog.h"
 #include "envelopes.h"
-
-static ScaleParams env1_level1_params = {
-    .parameter = PARAMETER_ENV1_LEVEL1,
-    .offset = 64
-};
-
-static ScaleParams env1_level2_params = {
-    .parameter = PARAMETER_ENV1_LEVEL2,
-    .offset = 64
-};
-
-static ScaleParams env1_level3_params = {
-    .parameter = PARAMETER_ENV1_LEVEL3,
-    .offset = 64
-};
-
-static ScaleParams env1_velocity_attack_params = {
-    .parameter = PARAMETER_ENV1_VELOCITY_ATTACK,
-    .multiplier = 2
-};
-
-static ScaleParams env1_time1_params = {
-    .parameter = PARAMETER_ENV1_TIME1,
-    .multiplier = 2
-};
-
-static ScaleParams env1_time2_params = {
-    .parameter = PARAMETER_ENV1_TIME2,
-    .multiplier = 2
-};
-
-static ScaleParams env1_time3_params = {
-    .parameter = PARAMETER_ENV1_TIME3,
-    .multiplier = 2
-};
-
-static ScaleParams env1_keyboard_decay_scaling_params = {
-    .parameter = PARAMETER_ENV1_KEYBOARD_DECAY_SCALING,
-    .multiplier = 2
-};
-
-static ScaleParams env2_level1_params = {
-    .parameter = PARAMETER_ENV2_LEVEL1,
-    .offset = 64
-};
-
-static ScaleParams env2_level2_params = {
-    .parameter = PARAMETER_ENV2_LEVEL2,
-    .offset = 64
-};
-
-static ScaleParams env2_level3_params = {
-    .parameter = PARAMETER_ENV2_LEVEL3,
-    .offset = 64
-};
-
-static ScaleParams env2_velocity_attack_params = {
-    .parameter = PARAMETER_ENV2_VELOCITY_ATTACK,
-    .multiplier = 2
-};
-
-static ScaleParams env2_time1_params = {
-    .parameter = PARAMETER_ENV2_TIME1,
-    .multiplier = 2
-};
-
-static ScaleParams env2_time2_params = {
-    .parameter = PARAMETER_ENV2_TIME2,
-    .multiplier = 2
-};
-
-static ScaleParams env2_time3_params = {
-    .parameter = PARAMETER_ENV2_TIME3,
-    .multiplier = 2
-};
-
-static ScaleParams env2_keyboard_decay_scaling_params = {
-    .parameter = PARAMETER_ENV2_KEYBOARD_DECAY_SCALING,
-    .multiplier = 2
-};
-
-static ScaleParams env3_level1_params = {
-    .parameter = PARAMETER_ENV3_LEVEL1,
-    .offset = 64
-};
-
-static ScaleParams env3_level2_params = {
-    .parameter = PARAMETER_ENV3_LEVEL2,
-    .offset = 64
-};
-
-static ScaleParams env3_level3_params = {
-    .parameter = PARAMETER_ENV3_LEVEL3,
-    .offset = 64
-};
-
-static ScaleParams env3_velocity_attack_params = {
-    .parameter = PARAMETER_ENV3_VELOCITY_ATTACK,
-    .multiplier = 2
-};
-
-static ScaleParams env3_time1_params = {
-    .parameter = PARAMETER_ENV3_TIME1,
-    .multiplier = 2
-};
-
-static ScaleParams env3_time2_params = {
-    .parameter = PARAMETER_ENV3_TIME2,
-    .multiplier = 2
-};
-
-static ScaleParams env3_time3_params = {
-    .parameter = PARAMETER_ENV3_TIME3,
-    .multiplier = 2
-};
-
-static ScaleParams env3_keyboard_decay_scaling_params = {
-    .parameter = PARAMETER_ENV3_KEYBOARD_DECAY_SCALING,
-    .multiplier = 2
-};
-
-static ScaleParams env4_level1_params = {
-    .parameter = PARAMETER_ENV4_LEVEL1,
-    .offset = 64
-};
-
-static ScaleParams env4_level2_params = {
-    .parameter = PARAMETER_ENV4_LEVEL2,
-    .offset = 64
-};
-
-static ScaleParams env4_level3_params = {
-    .parameter = PARAMETER_ENV4_LEVEL3,
-    .offset = 64
-};
-
-static ScaleParams env4_velocity_attack_params = {
-    .parameter = PARAMETER_ENV4_VELOCITY_ATTACK,
-    .multiplier = 2
-};
-
-static ScaleParams env4_time1_params = {
-    .parameter = PARAMETER_ENV4_TIME1,
-    .multiplier = 2
-};
-
-static ScaleParams env4_time2_params = {
-    .parameter = PARAMETER_ENV4_TIME2,
-    .multiplier = 2
-};
-
-static ScaleParams env4_time3_params = {
-    .parameter = PARAMETER_ENV4_TIME3,
-    .multiplier = 2
-};
-
-static ScaleParams env4_keyboard_decay_scaling_params = {
-    .parameter = PARAMETER_ENV4_KEYBOARD_DECAY_SCALING,
-    .multiplier = 2
-};
+#include "envgen.h"
 
 static GtkWidget *create_envelope1(Envelope *);
 static GtkWidget *create_envelope2(Envelope *);
 static GtkWidget *create_envelope3(Envelope *);
 static GtkWidget *create_envelope4(Envelope *);
 static gboolean envelope_event_callback(GtkWidget *, cairo_t *, gpointer);
+static void envelope_size_callback(GtkWidget *, GdkRectangle *, gpointer);
 static void envelope_callback(GtkWidget *, gpointer);
-static void envelope_draw(Envelope *);
+static void envelope_draw(Envelope *, cairo_t *);
+static cairo_surface_t *envelope_background(Envelope *, gint, gint);
 
 EnvelopesDialog *
 new_envelopes_dialog(GtkWindow *parent)
@@ -195,7 +42,7 @@ new_envelopes_dialog(GtkWindow *parent)
     GtkGrid *grid;
     GtkWidget *button_box, *button;
 
-    widgets = g_new(EnvelopesDialog, 1);
+    widgets = g_new0(EnvelopesDialog, 1);
 
     widgets->dialog = create_window(parent, "Envelopes", FALSE);
 
@@ -244,16 +91,16 @@ set_envelopes_parameters(EnvelopesDialog *widgets, Patch *patch)
         patch->parameters[PARAMETER_ENV1_TIME4],
         patch->parameters[PARAMETER_ENV1_KEYBOARD_DECAY_SCALING]);
 
-    gtk_range_set_value(GTK_RANGE(widgets->env1.level1), patch->parameters[PARAMETER_ENV1_LEVEL1]);
-    gtk_range_set_value(GTK_RANGE(widgets->env1.level2), patch->parameters[PARAMETER_ENV1_LEVEL2]);
-    gtk_range_set_value(GTK_RANGE(widgets->env1.level3), patch->parameters[PARAMETER_ENV1_LEVEL3]);
-    gtk_range_set_value(GTK_RANGE(widgets->env1.velocity_level), patch->parameters[PARAMETER_ENV1_VELOCITY_LEVEL]);
-    gtk_range_set_value(GTK_RANGE(widgets->env1.velocity_attack), patch->parameters[PARAMETER_ENV1_VELOCITY_ATTACK]);
-    gtk_range_set_value(GTK_RANGE(widgets->env1.time1), patch->parameters[PARAMETER_ENV1_TIME1]);
-    gtk_range_set_value(GTK_RANGE(widgets->env1.time2), patch->parameters[PARAMETER_ENV1_TIME2]);
-    gtk_range_set_value(GTK_RANGE(widgets->env1.time3), patch->parameters[PARAMETER_ENV1_TIME3]);
-    gtk_range_set_value(GTK_RANGE(widgets->env1.time4), patch->parameters[PARAMETER_ENV1_TIME4]);
-    gtk_range_set_value(GTK_RANGE(widgets->env1.keyboard_decay_scaling), patch->parameters[PARAMETER_ENV1_KEYBOARD_DECAY_SCALING]);
+    gtk_range_set_value(GTK_RANGE(widgets->env1.level1), parameters_decode(PARAMETER_ENV1_LEVEL1, patch->parameters[PARAMETER_ENV1_LEVEL1]));
+    gtk_range_set_value(GTK_RANGE(widgets->env1.level2), parameters_decode(PARAMETER_ENV1_LEVEL2, patch->parameters[PARAMETER_ENV1_LEVEL2]));
+    gtk_range_set_value(GTK_RANGE(widgets->env1.level3), parameters_decode(PARAMETER_ENV1_LEVEL3, patch->parameters[PARAMETER_ENV1_LEVEL3]));
+    gtk_range_set_value(GTK_RANGE(widgets->env1.velocity_level), parameters_decode(PARAMETER_ENV1_VELOCITY_LEVEL, patch->parameters[PARAMETER_ENV1_VELOCITY_LEVEL]));
+    gtk_range_set_value(GTK_RANGE(widgets->env1.velocity_attack), parameters_decode(PARAMETER_ENV1_VELOCITY_ATTACK, patch->parameters[PARAMETER_ENV1_VELOCITY_ATTACK]));
+    gtk_range_set_value(GTK_RANGE(widgets->env1.time1), parameters_decode(PARAMETER_ENV1_TIME1, patch->parameters[PARAMETER_ENV1_TIME1]));
+    gtk_range_set_value(GTK_RANGE(widgets->env1.time2), parameters_decode(PARAMETER_ENV1_TIME2, patch->parameters[PARAMETER_ENV1_TIME2]));
+    gtk_range_set_value(GTK_RANGE(widgets->env1.time3), parameters_decode(PARAMETER_ENV1_TIME3, patch->parameters[PARAMETER_ENV1_TIME3]));
+    gtk_range_set_value(GTK_RANGE(widgets->env1.time4), parameters_decode(PARAMETER_ENV1_TIME4, patch->parameters[PARAMETER_ENV1_TIME4]));
+    gtk_range_set_value(GTK_RANGE(widgets->env1.keyboard_decay_scaling), parameters_decode(PARAMETER_ENV1_KEYBOARD_DECAY_SCALING, patch->parameters[PARAMETER_ENV1_KEYBOARD_DECAY_SCALING]));
 
     printf("Setting env 2 parameters: level 1 %d, level 2 %d, level 3 %d, vel level %d, vel attack %d, time 1 %d, time 2 %d, time 3 %d, time 4 %d, key scaling %d\n",
         patch->parameters[PARAMETER_ENV2_LEVEL1],
@@ -267,16 +114,16 @@ set_envelopes_parameters(EnvelopesDialog *widgets, Patch *patch)
         patch->parameters[PARAMETER_ENV2_TIME4],
         patch->parameters[PARAMETER_ENV2_KEYBOARD_DECAY_SCALING]);
 
-    gtk_range_set_value(GTK_RANGE(widgets->env2.level1), patch->parameters[PARAMETER_ENV2_LEVEL1]);
-    gtk_range_set_value(GTK_RANGE(widgets->env2.level2), patch->parameters[PARAMETER_ENV2_LEVEL2]);
-    gtk_range_set_value(GTK_RANGE(widgets->env2.level3), patch->parameters[PARAMETER_ENV2_LEVEL3]);
-    gtk_range_set_value(GTK_RANGE(widgets->env2.velocity_level), patch->parameters[PARAMETER_ENV2_VELOCITY_LEVEL]);
-    gtk_range_set_value(GTK_RANGE(widgets->env2.velocity_attack), patch->parameters[PARAMETER_ENV2_VELOCITY_ATTACK]);
-    gtk_range_set_value(GTK_RANGE(widgets->env2.time1), patch->parameters[PARAMETER_ENV2_TIME1]);
-    gtk_range_set_value(GTK_RANGE(widgets->env2.time2), patch->parameters[PARAMETER_ENV2_TIME2]);
-    gtk_range_set_value(GTK_RANGE(widgets->env2.time3), patch->parameters[PARAMETER_ENV2_TIME3]);
-    gtk_range_set_value(GTK_RANGE(widgets->env2.time4), patch->parameters[PARAMETER_ENV2_TIME4]);
-    gtk_range_set_value(GTK_RANGE(widgets->env2.keyboard_decay_scaling), patch->parameters[PARAMETER_ENV2_KEYBOARD_DECAY_SCALING]);
+    gtk_range_set_value(GTK_RANGE(widgets->env2.level1), parameters_decode(PARAMETER_ENV2_LEVEL1, patch->parameters[PARAMETER_ENV2_LEVEL1]));
+    gtk_range_set_value(GTK_RANGE(widgets->env2.level2), parameters_decode(PARAMETER_ENV2_LEVEL2, patch->parameters[PARAMETER_ENV2_LEVEL2]));
+    gtk_range_set_value(GTK_RANGE(widgets->env2.level3), parameters_decode(PARAMETER_ENV2_LEVEL3, patch->parameters[PARAMETER_ENV2_LEVEL3]));
+    gtk_range_set_value(GTK_RANGE(widgets->env2.velocity_level), parameters_decode(PARAMETER_ENV2_VELOCITY_LEVEL, patch->parameters[PARAMETER_ENV2_VELOCITY_LEVEL]));
+    gtk_range_set_value(GTK_RANGE(widgets->env2.velocity_attack), parameters_decode(PARAMETER_ENV2_VELOCITY_ATTACK, patch->parameters[PARAMETER_ENV2_VELOCITY_ATTACK]));
+    gtk_range_set_value(GTK_RANGE(widgets->env2.time1), parameters_decode(PARAMETER_ENV2_TIME1, patch->parameters[PARAMETER_ENV2_TIME1]));
+    gtk_range_set_value(GTK_RANGE(widgets->env2.time2), parameters_decode(PARAMETER_ENV2_TIME2, patch->parameters[PARAMETER_ENV2_TIME2]));
+    gtk_range_set_value(GTK_RANGE(widgets->env2.time3), parameters_decode(PARAMETER_ENV2_TIME3, patch->parameters[PARAMETER_ENV2_TIME3]));
+    gtk_range_set_value(GTK_RANGE(widgets->env2.time4), parameters_decode(PARAMETER_ENV2_TIME4, patch->parameters[PARAMETER_ENV2_TIME4]));
+    gtk_range_set_value(GTK_RANGE(widgets->env2.keyboard_decay_scaling), parameters_decode(PARAMETER_ENV2_KEYBOARD_DECAY_SCALING, patch->parameters[PARAMETER_ENV2_KEYBOARD_DECAY_SCALING]));
 
     printf("Setting env 3 parameters: level 1 %d, level 2 %d, level 3 %d, vel level %d, vel attack %d, time 1 %d, time 2 %d, time 3 %d, time 4 %d, key scaling %d\n",
         patch->parameters[PARAMETER_ENV3_LEVEL1],
@@ -290,16 +137,16 @@ set_envelopes_parameters(EnvelopesDialog *widgets, Patch *patch)
         patch->parameters[PARAMETER_ENV3_TIME4],
         patch->parameters[PARAMETER_ENV3_KEYBOARD_DECAY_SCALING]);
 
-    gtk_range_set_value(GTK_RANGE(widgets->env3.level1), patch->parameters[PARAMETER_ENV3_LEVEL1]);
-    gtk_range_set_value(GTK_RANGE(widgets->env3.level2), patch->parameters[PARAMETER_ENV3_LEVEL2]);
-    gtk_range_set_value(GTK_RANGE(widgets->env3.level3), patch->parameters[PARAMETER_ENV3_LEVEL3]);
-    gtk_range_set_value(GTK_RANGE(widgets->env3.velocity_level), patch->parameters[PARAMETER_ENV3_VELOCITY_LEVEL]);
-    gtk_range_set_value(GTK_RANGE(widgets->env3.velocity_attack), patch->parameters[PARAMETER_ENV3_VELOCITY_ATTACK]);
-    gtk_range_set_value(GTK_RANGE(widgets->env3.time1), patch->parameters[PARAMETER_ENV3_TIME1]);
-    gtk_range_set_value(GTK_RANGE(widgets->env3.time2), patch->parameters[PARAMETER_ENV3_TIME2]);
-    gtk_range_set_value(GTK_RANGE(widgets->env3.time3), patch->parameters[PARAMETER_ENV3_TIME3]);
-    gtk_range_set_value(GTK_RANGE(widgets->env3.time4), patch->parameters[PARAMETER_ENV3_TIME4]);
-    gtk_range_set_value(GTK_RANGE(widgets->env3.keyboard_decay_scaling), patch->parameters[PARAMETER_ENV3_KEYBOARD_DECAY_SCALING]);
+    gtk_range_set_value(GTK_RANGE(widgets->env3.level1), parameters_decode(PARAMETER_ENV3_LEVEL1, patch->parameters[PARAMETER_ENV3_LEVEL1]));
+    gtk_range_set_value(GTK_RANGE(widgets->env3.level2), parameters_decode(PARAMETER_ENV3_LEVEL2, patch->parameters[PARAMETER_ENV3_LEVEL2]));
+    gtk_range_set_value(GTK_RANGE(widgets->env3.level3), parameters_decode(PARAMETER_ENV3_LEVEL3, patch->parameters[PARAMETER_ENV3_LEVEL3]));
+    gtk_range_set_value(GTK_RANGE(widgets->env3.velocity_level), parameters_decode(PARAMETER_ENV3_VELOCITY_LEVEL, patch->parameters[PARAMETER_ENV3_VELOCITY_LEVEL]));
+    gtk_range_set_value(GTK_RANGE(widgets->env3.velocity_attack), parameters_decode(PARAMETER_ENV3_VELOCITY_ATTACK, patch->parameters[PARAMETER_ENV3_VELOCITY_ATTACK]));
+    gtk_range_set_value(GTK_RANGE(widgets->env3.time1), parameters_decode(PARAMETER_ENV3_TIME1, patch->parameters[PARAMETER_ENV3_TIME1]));
+    gtk_range_set_value(GTK_RANGE(widgets->env3.time2), parameters_decode(PARAMETER_ENV3_TIME2, patch->parameters[PARAMETER_ENV3_TIME2]));
+    gtk_range_set_value(GTK_RANGE(widgets->env3.time3), parameters_decode(PARAMETER_ENV3_TIME3, patch->parameters[PARAMETER_ENV3_TIME3]));
+    gtk_range_set_value(GTK_RANGE(widgets->env3.time4), parameters_decode(PARAMETER_ENV3_TIME4, patch->parameters[PARAMETER_ENV3_TIME4]));
+    gtk_range_set_value(GTK_RANGE(widgets->env3.keyboard_decay_scaling), parameters_decode(PARAMETER_ENV3_KEYBOARD_DECAY_SCALING, patch->parameters[PARAMETER_ENV3_KEYBOARD_DECAY_SCALING]));
 
     printf("Setting env 4 parameters: level 1 %d, level 2 %d, level 3 %d, vel level %d, vel attack %d, time 1 %d, time 2 %d, time 3 %d, time 4 %d, key scaling %d\n",
         patch->parameters[PARAMETER_ENV4_LEVEL1],
@@ -313,16 +160,16 @@ set_envelopes_parameters(EnvelopesDialog *widgets, Patch *patch)
         patch->parameters[PARAMETER_ENV4_TIME4],
         patch->parameters[PARAMETER_ENV4_KEYBOARD_DECAY_SCALING]);
 
-    gtk_range_set_value(GTK_RANGE(widgets->env4.level1), patch->parameters[PARAMETER_ENV4_LEVEL1]);
-    gtk_range_set_value(GTK_RANGE(widgets->env4.level2), patch->parameters[PARAMETER_ENV4_LEVEL2]);
-    gtk_range_set_value(GTK_RANGE(widgets->env4.level3), patch->parameters[PARAMETER_ENV4_LEVEL3]);
-    gtk_range_set_value(GTK_RANGE(widgets->env4.velocity_level), patch->parameters[PARAMETER_ENV4_VELOCITY_LEVEL]);
-    gtk_range_set_value(GTK_RANGE(widgets->env4.velocity_attack), patch->parameters[PARAMETER_ENV4_VELOCITY_ATTACK]);
-    gtk_range_set_value(GTK_RANGE(widgets->env4.time1), patch->parameters[PARAMETER_ENV4_TIME1]);
-    gtk_range_set_value(GTK_RANGE(widgets->env4.time2), patch->parameters[PARAMETER_ENV4_TIME2]);
-    gtk_range_set_value(GTK_RANGE(widgets->env4.time3), patch->parameters[PARAMETER_ENV4_TIME3]);
-    gtk_range_set_value(GTK_RANGE(widgets->env4.time4), patch->parameters[PARAMETER_ENV4_TIME4]);
-    gtk_range_set_value(GTK_RANGE(widgets->env4.keyboard_decay_scaling), patch->parameters[PARAMETER_ENV4_KEYBOARD_DECAY_SCALING]);
+    gtk_range_set_value(GTK_RANGE(widgets->env4.level1), parameters_decode(PARAMETER_ENV4_LEVEL1, patch->parameters[PARAMETER_ENV4_LEVEL1]));
+    gtk_range_set_value(GTK_RANGE(widgets->env4.level2), parameters_decode(PARAMETER_ENV4_LEVEL2, patch->parameters[PARAMETER_ENV4_LEVEL2]));
+    gtk_range_set_value(GTK_RANGE(widgets->env4.level3), parameters_decode(PARAMETER_ENV4_LEVEL3, patch->parameters[PARAMETER_ENV4_LEVEL3]));
+    gtk_range_set_value(GTK_RANGE(widgets->env4.velocity_level), parameters_decode(PARAMETER_ENV4_VELOCITY_LEVEL, patch->parameters[PARAMETER_ENV4_VELOCITY_LEVEL]));
+    gtk_range_set_value(GTK_RANGE(widgets->env4.velocity_attack), parameters_decode(PARAMETER_ENV4_VELOCITY_ATTACK, patch->parameters[PARAMETER_ENV4_VELOCITY_ATTACK]));
+    gtk_range_set_value(GTK_RANGE(widgets->env4.time1), parameters_decode(PARAMETER_ENV4_TIME1, patch->parameters[PARAMETER_ENV4_TIME1]));
+    gtk_range_set_value(GTK_RANGE(widgets->env4.time2), parameters_decode(PARAMETER_ENV4_TIME2, patch->parameters[PARAMETER_ENV4_TIME2]));
+    gtk_range_set_value(GTK_RANGE(widgets->env4.time3), parameters_decode(PARAMETER_ENV4_TIME3, patch->parameters[PARAMETER_ENV4_TIME3]));
+    gtk_range_set_value(GTK_RANGE(widgets->env4.time4), parameters_decode(PARAMETER_ENV4_TIME4, patch->parameters[PARAMETER_ENV4_TIME4]));
+    gtk_range_set_value(GTK_RANGE(widgets->env4.keyboard_decay_scaling), parameters_decode(PARAMETER_ENV4_KEYBOARD_DECAY_SCALING, patch->parameters[PARAMETER_ENV4_KEYBOARD_DECAY_SCALING]));
 }
 
 void
@@ -390,51 +237,53 @@ create_envelope1(Envelope *env)
     env->envelope = gtk_drawing_area_new();
     gtk_widget_set_size_request(GTK_WIDGET(env->envelope), 317, 127);
     g_signal_connect(G_OBJECT(env->envelope), "draw", G_CALLBACK(envelope_event_callback), env);
+    g_signal_connect(G_OBJECT(env->envelope), "size-allocate", G_CALLBACK(envelope_size_callback), env);
     gtk_container_add(GTK_CONTAINER(envelope_frame), env->envelope);
 
     label = gtk_label_new("Level 1:");
-    env->level1 = create_hscale_with_params(-63, 63, &env1_level1_params);
+    env->level1 = create_hscale(PARAMETER_ENV1_LEVEL1);
     g_signal_connect(G_OBJECT(env->level1), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(env->level1));
 
     label = gtk_label_new("Level 2:");
-    env->level2 = create_hscale_with_params(-63, 63, &env1_level2_params);
+    env->level2 = create_hscale(PARAMETER_ENV1_LEVEL2);
     g_signal_connect(G_OBJECT(env->level2), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(env->level2));
 
     label = gtk_label_new("Level 3:");
-    env->level3 = create_hscale_with_params(-63, 63, &env1_level3_params);
+    env->level3 = create_hscale(PARAMETER_ENV1_LEVEL3);
     g_signal_connect(G_OBJECT(env->level3), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(env->level3));
 
     label = gtk_label_new("Velocity Level:");
-    env->velocity_level = create_hscale(0, 127, PARAMETER_ENV1_VELOCITY_LEVEL);
+    env->velocity_level = create_hscale(PARAMETER_ENV1_VELOCITY_LEVEL);
     create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(env->velocity_level));
 
     label = gtk_label_new("(0 - 63 linear, 64 - 127 exponential)");
     gtk_grid_attach(grid, label, 0, 5, 2, 1);
 
     label = gtk_label_new("Velocity Attack:");
-    env->velocity_attack = create_hscale_with_params(0, 63, &env1_velocity_attack_params);
+    env->velocity_attack = create_hscale(PARAMETER_ENV1_VELOCITY_ATTACK);
+    g_signal_connect(G_OBJECT(env->velocity_attack), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(env->velocity_attack));
 
     label = gtk_label_new("Time 1:");
-    env->time1 = create_hscale_with_params(0, 63, &env1_time1_params);
+    env->time1 = create_hscale(PARAMETER_ENV1_TIME1);
     g_signal_connect(G_OBJECT(env->time1), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 7, GTK_LABEL(label), GTK_WIDGET(env->time1));
 
     label = gtk_label_new("Time 2:");
-    env->time2 = create_hscale_with_params(0, 63, &env1_time2_params);
+    env->time2 = create_hscale(PARAMETER_ENV1_TIME2);
     g_signal_connect(G_OBJECT(env->time2), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 8, GTK_LABEL(label), GTK_WIDGET(env->time2));
 
     label = gtk_label_new("Time 3:");
-    env->time3 = create_hscale_with_params(0, 63, &env1_time3_params);
+    env->time3 = create_hscale(PARAMETER_ENV1_TIME3);
     g_signal_connect(G_OBJECT(env->time3), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 9, GTK_LABEL(label), GTK_WIDGET(env->time3));
 
     label = gtk_label_new("Time 4:");
-    env->time4 = create_hscale(0, 127, PARAMETER_ENV1_TIME4);
+    env->time4 = create_hscale(PARAMETER_ENV1_TIME4);
     g_signal_connect(G_OBJECT(env->time4), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 10, GTK_LABEL(label), GTK_WIDGET(env->time4));
 
@@ -442,7 +291,7 @@ create_envelope1(Envelope *env)
     gtk_grid_attach(grid, label, 0, 11, 2, 1);
 
     label = gtk_label_new("Keyboard Decay Scaling:");
-    env->keyboard_decay_scaling = create_hscale_with_params(0, 63, &env1_keyboard_decay_scaling_params);
+    env->keyboard_decay_scaling = create_hscale(PARAMETER_ENV1_KEYBOARD_DECAY_SCALING);
     create_grid_row(grid, 12, GTK_LABEL(label), GTK_WIDGET(env->keyboard_decay_scaling));
 
     return frame;
@@ -465,51 +314,53 @@ create_envelope2(Envelope *env)
     env->envelope = gtk_drawing_area_new();
     gtk_widget_set_size_request(GTK_WIDGET(env->envelope), 317, 127);
     g_signal_connect(G_OBJECT(env->envelope), "draw", G_CALLBACK(envelope_event_callback), env);
+    g_signal_connect(G_OBJECT(env->envelope), "size-allocate", G_CALLBACK(envelope_size_callback), env);
     gtk_container_add(GTK_CONTAINER(envelope_frame), env->envelope);
 
     label = gtk_label_new("Level 1:");
-    env->level1 = create_hscale_with_params(-63, 63, &env2_level1_params);
+    env->level1 = create_hscale(PARAMETER_ENV2_LEVEL1);
     g_signal_connect(G_OBJECT(env->level1), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(env->level1));
 
     label = gtk_label_new("Level 2:");
-    env->level2 = create_hscale_with_params(-63, 63, &env2_level2_params);
+    env->level2 = create_hscale(PARAMETER_ENV2_LEVEL2);
     g_signal_connect(G_OBJECT(env->level2), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(env->level2));
 
     label = gtk_label_new("Level 3:");
-    env->level3 = create_hscale_with_params(-63, 63, &env2_level3_params);
+    env->level3 = create_hscale(PARAMETER_ENV2_LEVEL3);
     g_signal_connect(G_OBJECT(env->level3), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(env->level3));
 
     label = gtk_label_new("Velocity Level:");
-    env->velocity_level = create_hscale(0, 127, PARAMETER_ENV2_VELOCITY_LEVEL);
+    env->velocity_level = create_hscale(PARAMETER_ENV2_VELOCITY_LEVEL);
     create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(env->velocity_level));
 
     label = gtk_label_new("(0 - 63 linear, 64 - 127 exponential)");
     gtk_grid_attach(grid, label, 0, 5, 2, 1);
 
     label = gtk_label_new("Velocity Attack:");
-    env->velocity_attack = create_hscale_with_params(0, 63, &env2_velocity_attack_params);
+    env->velocity_attack = create_hscale(PARAMETER_ENV2_VELOCITY_ATTACK);
+    g_signal_connect(G_OBJECT(env->velocity_attack), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(env->velocity_attack));
 
     label = gtk_label_new("Time 1:");
-    env->time1 = create_hscale_with_params(0, 63, &env2_time1_params);
+    env->time1 = create_hscale(PARAMETER_ENV2_TIME1);
     g_signal_connect(G_OBJECT(env->time1), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 7, GTK_LABEL(label), GTK_WIDGET(env->time1));
 
     label = gtk_label_new("Time 2:");
-    env->time2 = create_hscale_with_params(0, 63, &env2_time2_params);
+    env->time2 = create_hscale(PARAMETER_ENV2_TIME2);
     g_signal_connect(G_OBJECT(env->time2), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 8, GTK_LABEL(label), GTK_WIDGET(env->time2));
 
     label = gtk_label_new("Time 3:");
-    env->time3 = create_hscale_with_params(0, 63, &env2_time3_params);
+    env->time3 = create_hscale(PARAMETER_ENV2_TIME3);
     g_signal_connect(G_OBJECT(env->time3), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 9, GTK_LABEL(label), GTK_WIDGET(env->time3));
 
     label = gtk_label_new("Time 4:");
-    env->time4 = create_hscale(0, 127, PARAMETER_ENV2_TIME4);
+    env->time4 = create_hscale(PARAMETER_ENV2_TIME4);
     g_signal_connect(G_OBJECT(env->time4), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 10, GTK_LABEL(label), GTK_WIDGET(env->time4));
 
@@ -517,7 +368,7 @@ create_envelope2(Envelope *env)
     gtk_grid_attach(grid, label, 0, 11, 2, 1);
 
     label = gtk_label_new("Keyboard Decay Scaling:");
-    env->keyboard_decay_scaling = create_hscale_with_params(0, 63, &env2_keyboard_decay_scaling_params);
+    env->keyboard_decay_scaling = create_hscale(PARAMETER_ENV2_KEYBOARD_DECAY_SCALING);
     create_grid_row(grid, 12, GTK_LABEL(label), GTK_WIDGET(env->keyboard_decay_scaling));
 
     return frame;
@@ -540,51 +391,53 @@ create_envelope3(Envelope *env)
     env->envelope = gtk_drawing_area_new();
     gtk_widget_set_size_request(GTK_WIDGET(env->envelope), 317, 127);
     g_signal_connect(G_OBJECT(env->envelope), "draw", G_CALLBACK(envelope_event_callback), env);
+    g_signal_connect(G_OBJECT(env->envelope), "size-allocate", G_CALLBACK(envelope_size_callback), env);
     gtk_container_add(GTK_CONTAINER(envelope_frame), env->envelope);
 
     label = gtk_label_new("Level 1:");
-    env->level1 = create_hscale_with_params(-63, 63, &env3_level1_params);
+    env->level1 = create_hscale(PARAMETER_ENV3_LEVEL1);
     g_signal_connect(G_OBJECT(env->level1), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(env->level1));
 
     label = gtk_label_new("Level 2:");
-    env->level2 = create_hscale_with_params(-63, 63, &env3_level2_params);
+    env->level2 = create_hscale(PARAMETER_ENV3_LEVEL2);
     g_signal_connect(G_OBJECT(env->level2), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(env->level2));
 
     label = gtk_label_new("Level 3:");
-    env->level3 = create_hscale_with_params(-63, 63, &env3_level3_params);
+    env->level3 = create_hscale(PARAMETER_ENV3_LEVEL3);
     g_signal_connect(G_OBJECT(env->level3), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(env->level3));
 
     label = gtk_label_new("Velocity Level:");
-    env->velocity_level = create_hscale(0, 127, PARAMETER_ENV3_VELOCITY_LEVEL);
+    env->velocity_level = create_hscale(PARAMETER_ENV3_VELOCITY_LEVEL);
     create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(env->velocity_level));
 
     label = gtk_label_new("(0 - 63 linear, 64 - 127 exponential)");
     gtk_grid_attach(grid, label, 0, 5, 2, 1);
 
     label = gtk_label_new("Velocity Attack:");
-    env->velocity_attack = create_hscale_with_params(0, 63, &env3_velocity_attack_params);
+    env->velocity_attack = create_hscale(PARAMETER_ENV3_VELOCITY_ATTACK);
+    g_signal_connect(G_OBJECT(env->velocity_attack), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(env->velocity_attack));
 
     label = gtk_label_new("Time 1:");
-    env->time1 = create_hscale_with_params(0, 63, &env3_time1_params);
+    env->time1 = create_hscale(PARAMETER_ENV3_TIME1);
     g_signal_connect(G_OBJECT(env->time1), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 7, GTK_LABEL(label), GTK_WIDGET(env->time1));
 
     label = gtk_label_new("Time 2:");
-    env->time2 = create_hscale_with_params(0, 63, &env3_time2_params);
+    env->time2 = create_hscale(PARAMETER_ENV3_TIME2);
     g_signal_connect(G_OBJECT(env->time2), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 8, GTK_LABEL(label), GTK_WIDGET(env->time2));
 
     label = gtk_label_new("Time 3:");
-    env->time3 = create_hscale_with_params(0, 63, &env3_time3_params);
+    env->time3 = create_hscale(PARAMETER_ENV3_TIME3);
     g_signal_connect(G_OBJECT(env->time3), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 9, GTK_LABEL(label), GTK_WIDGET(env->time3));
 
     label = gtk_label_new("Time 4:");
-    env->time4 = create_hscale(0, 127, PARAMETER_ENV3_TIME4);
+    env->time4 = create_hscale(PARAMETER_ENV3_TIME4);
     g_signal_connect(G_OBJECT(env->time4), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 10, GTK_LABEL(label), GTK_WIDGET(env->time4));
 
@@ -592,7 +445,7 @@ create_envelope3(Envelope *env)
     gtk_grid_attach(grid, label, 0, 11, 2, 1);
 
     label = gtk_label_new("Keyboard Decay Scaling:");
-    env->keyboard_decay_scaling = create_hscale_with_params(0, 63, &env3_keyboard_decay_scaling_params);
+    env->keyboard_decay_scaling = create_hscale(PARAMETER_ENV3_KEYBOARD_DECAY_SCALING);
     create_grid_row(grid, 12, GTK_LABEL(label), GTK_WIDGET(env->keyboard_decay_scaling));
 
     return frame;
@@ -615,51 +468,53 @@ create_envelope4(Envelope *env)
     env->envelope = gtk_drawing_area_new();
     gtk_widget_set_size_request(GTK_WIDGET(env->envelope), 317, 127);
     g_signal_connect(G_OBJECT(env->envelope), "draw", G_CALLBACK(envelope_event_callback), env);
+    g_signal_connect(G_OBJECT(env->envelope), "size-allocate", G_CALLBACK(envelope_size_callback), env);
     gtk_container_add(GTK_CONTAINER(envelope_frame), env->envelope);
 
     label = gtk_label_new("Level 1:");
-    env->level1 = create_hscale_with_params(-63, 63, &env4_level1_params);
+    env->level1 = create_hscale(PARAMETER_ENV4_LEVEL1);
     g_signal_connect(G_OBJECT(env->level1), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(env->level1));
 
     label = gtk_label_new("Level 2:");
-    env->level2 = create_hscale_with_params(-63, 63, &env4_level2_params);
+    env->level2 = create_hscale(PARAMETER_ENV4_LEVEL2);
     g_signal_connect(G_OBJECT(env->level2), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(env->level2));
 
     label = gtk_label_new("Level 3:");
-    env->level3 = create_hscale_with_params(-63, 63, &env4_level3_params);
+    env->level3 = create_hscale(PARAMETER_ENV4_LEVEL3);
     g_signal_connect(G_OBJECT(env->level3), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(env->level3));
 
     label = gtk_label_new("Velocity Level:");
-    env->velocity_level = create_hscale(0, 127, PARAMETER_ENV4_VELOCITY_LEVEL);
+    env->velocity_level = create_hscale(PARAMETER_ENV4_VELOCITY_LEVEL);
     create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(env->velocity_level));
 
     label = gtk_label_new("(0 - 63 linear, 64 - 127 exponential)");
     gtk_grid_attach(grid, label, 0, 5, 2, 1);
 
     label = gtk_label_new("Velocity Attack:");
-    env->velocity_attack = create_hscale_with_params(0, 63, &env4_velocity_attack_params);
+    env->velocity_attack = create_hscale(PARAMETER_ENV4_VELOCITY_ATTACK);
+    g_signal_connect(G_OBJECT(env->velocity_attack), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(env->velocity_attack));
 
     label = gtk_label_new("Time 1:");
-    env->time1 = create_hscale_with_params(0, 63, &env4_time1_params);
+    env->time1 = create_hscale(PARAMETER_ENV4_TIME1);
     g_signal_connect(G_OBJECT(env->time1), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 7, GTK_LABEL(label), GTK_WIDGET(env->time1));
 
     label = gtk_label_new("Time 2:");
-    env->time2 = create_hscale_with_params(0, 63, &env4_time2_params);
+    env->time2 = create_hscale(PARAMETER_ENV4_TIME2);
     g_signal_connect(G_OBJECT(env->time2), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 8, GTK_LABEL(label), GTK_WIDGET(env->time2));
 
     label = gtk_label_new("Time 3:");
-    env->time3 = create_hscale_with_params(0, 63, &env4_time3_params);
+    env->time3 = create_hscale(PARAMETER_ENV4_TIME3);
     g_signal_connect(G_OBJECT(env->time3), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 9, GTK_LABEL(label), GTK_WIDGET(env->time3));
 
     label = gtk_label_new("Time 4:");
-    env->time4 = create_hscale(0, 127, PARAMETER_ENV4_TIME4);
+    env->time4 = create_hscale(PARAMETER_ENV4_TIME4);
     g_signal_connect(G_OBJECT(env->time4), "value-changed", G_CALLBACK(envelope_callback), env);
     create_grid_row(grid, 10, GTK_LABEL(label), GTK_WIDGET(env->time4));
 
@@ -667,70 +522,99 @@ create_envelope4(Envelope *env)
     gtk_grid_attach(grid, label, 0, 11, 2, 1);
 
     label = gtk_label_new("Keyboard Decay Scaling:");
-    env->keyboard_decay_scaling = create_hscale_with_params(0, 63, &env4_keyboard_decay_scaling_params);
+    env->keyboard_decay_scaling = create_hscale(PARAMETER_ENV4_KEYBOARD_DECAY_SCALING);
     create_grid_row(grid, 12, GTK_LABEL(label), GTK_WIDGET(env->keyboard_decay_scaling));
 
     return frame;
 }
+
 static gboolean
 envelope_event_callback(GtkWidget *widget, cairo_t *cairo, gpointer data)
 {
     Envelope *env = (Envelope *) data;
 
-    envelope_draw(env);
+    envelope_draw(env, cairo);
 
     return TRUE;
 }
 
+static void
+envelope_size_callback(GtkWidget *widget, GdkRectangle *allocation, gpointer data)
+{
+    Envelope *env = (Envelope *) data;
+
+    /* the cached background no longer fits, so rebuild it on the next draw */
+    if (env->background) {
+        cairo_surface_destroy(env->background);
+        env->background = NULL;
+    }
+}
+
 static void
 envelope_callback(GtkWidget *widget, gpointer data)
 {
     Envelope *env = (Envelope *) data;
 
+    /* coalesced by GTK into at most one draw per frame clock tick */
     if (gtk_widget_get_visible(GTK_WIDGET(env->dialog))) {
-        envelope_draw(env);
+        gtk_widget_queue_draw(env->envelope);
     }
 }
 
+/*
+ * Draws the envelope for a note at middle C and full velocity, held for a
+ * second after the third segment. The time axis is logarithmic so that both
+ * the short and long segments remain visible.
+ */
 static void
-envelope_draw(Envelope *widgets)
+envelope_draw(Envelope *widgets, cairo_t *cairo)
 {
     GtkAllocation allocation;
-    GdkWindow *window;
-    GdkDrawingContext *drawing_context;
-    cairo_region_t *cairo_region;
-    cairo_t *cairo;
-    gint t1, l1, t2, l2, t3, l3, t4;
+    guchar values[ENVGEN_PARAMETER_COUNT];
+    EnvParams params;
+    EnvPoint points[ENVGEN_MAX_POINTS];
+    gdouble x[ENVGEN_MAX_POINTS], y[ENVGEN_MAX_POINTS], total, baseline, height;
+    gint i, n;
     double dashes[2];
 
     gtk_widget_get_allocation(widgets->envelope, &allocation);
 
-    t1 = gtk_range_get_value(GTK_RANGE(widgets->time1)) / 2;
-    l1 = gtk_range_get_value(GTK_RANGE(widgets->level1));
-    t2 = gtk_range_get_value(GTK_RANGE(widgets->time2)) / 2 + t1;
-    l2 = gtk_range_get_value(GTK_RANGE(widgets->level2));
-    t3 = gtk_range_get_value(GTK_RANGE(widgets->time3)) / 2 + t2;
-    l3 = gtk_range_get_value(GTK_RANGE(widgets->level3));
-    t4 = gtk_range_get_value(GTK_RANGE(widgets->time4)) / 2;
+    values[0] = (gint) gtk_range_get_value(GTK_RANGE(widgets->level1));
+    values[1] = (gint) gtk_range_get_value(GTK_RANGE(widgets->level2));
+    values[2] = (gint) gtk_range_get_value(GTK_RANGE(widgets->level3));
+    values[3] = gtk_range_get_value(GTK_RANGE(widgets->velocity_level));
+    values[4] = gtk_range_get_value(GTK_RANGE(widgets->velocity_attack));
+    values[5] = gtk_range_get_value(GTK_RANGE(widgets->time1));
+    values[6] = gtk_range_get_value(GTK_RANGE(widgets->time2));
+    values[7] = gtk_range_get_value(GTK_RANGE(widgets->time3));
+    values[8] = gtk_range_get_value(GTK_RANGE(widgets->time4));
+    values[9] = gtk_range_get_value(GTK_RANGE(widgets->keyboard_decay_scaling));
+
+    envgen_params(&params, values, 60, 127);
+    n = envgen_breakpoints(&params, 1.0f, points);
+
+    /* negative levels need the zero line in the middle */
+    baseline = allocation.height;
+    for (i = 0; i < 3; ++i) {
+        if (params.level[i] < 0) {
+            baseline = allocation.height / 2.0;
+        }
+    }
+    height = baseline - 2;
+
+    total = log1p(points[n - 1].time / 0.01);
+    for (i = 0; i < n; ++i) {
+        x[i] = allocation.width * log1p(points[i].time / 0.01) / total;
+        y[i] = baseline - points[i].level * height;
+    }
 
     dashes[0] = 2;
     dashes[1] = 2;
 
-    /* create graphics context */
-
-    window = gtk_widget_get_window(widgets->envelope);
-
-    cairo_region = cairo_region_create();
-
-    drawing_context = gdk_window_begin_draw_frame(window, cairo_region);
-
-    cairo = gdk_drawing_context_get_cairo_context(drawing_context);
-
     /* draw background */
 
-    cairo_set_source_rgb(cairo, 255, 255, 255);
-    cairo_rectangle(cairo, 0, 0, allocation.width, allocation.height);
-    cairo_fill(cairo);
+    cairo_set_source_surface(cairo, envelope_background(widgets, allocation.width, allocation.height), 0, 0);
+    cairo_paint(cairo);
 
     /* draw envelope */
 
@@ -740,12 +624,10 @@ envelope_draw(Envelope *widgets)
     cairo_set_line_cap(cairo, CAIRO_LINE_CAP_ROUND);
     cairo_set_line_join(cairo, CAIRO_LINE_JOIN_ROUND);
 
-    cairo_move_to(cairo, 0, allocation.height);
-    cairo_line_to(cairo, t1, allocation.height - l1);
-    cairo_line_to(cairo, t2, allocation.height - l2);
-    cairo_line_to(cairo, t3, allocation.height - l3);
-    cairo_line_to(cairo, allocation.width - t4, allocation.height - l3);
-    cairo_line_to(cairo, allocation.width, allocation.height);
+    cairo_move_to(cairo, x[0], y[0]);
+    for (i = 1; i < n; ++i) {
+        cairo_line_to(cairo, x[i], y[i]);
+    }
     cairo_stroke(cairo);
 
     /* draw dashed lines */
@@ -755,25 +637,47 @@ envelope_draw(Envelope *widgets)
     cairo_set_line_cap(cairo, CAIRO_LINE_CAP_BUTT);
     cairo_set_line_join(cairo, CAIRO_LINE_JOIN_MITER);
 
-    cairo_move_to(cairo, t1, allocation.height - 0);
-    cairo_line_to(cairo, t1, allocation.height - l1);
+    for (i = 1; i < n - 1; ++i) {
+        cairo_move_to(cairo, x[i], baseline);
+        cairo_line_to(cairo, x[i], y[i]);
+    }
     cairo_stroke(cairo);
+}
 
-    cairo_move_to(cairo, t2, allocation.height - 0);
-    cairo_line_to(cairo, t2, allocation.height - l2);
-    cairo_stroke(cairo);
+/*
+ * Returns the background and grid of an envelope graphic, which only needs
+ * to be drawn again when the drawing area changes size.
+ */
+static cairo_surface_t *
+envelope_background(Envelope *widgets, gint width, gint height)
+{
+    cairo_t *cairo;
+    gint i;
 
-    cairo_move_to(cairo, t3, allocation.height - 0);
-    cairo_line_to(cairo, t3, allocation.height - l3);
-    cairo_stroke(cairo);
+    if (widgets->background) {
+        return widgets->background;
+    }
 
-    cairo_move_to(cairo, allocation.width - t4, allocation.height - 0);
-    cairo_line_to(cairo, allocation.width - t4, allocation.height - l3);
-    cairo_stroke(cairo);
+    widgets->background = gdk_window_create_similar_surface(gtk_widget_get_window(widgets->envelope), CAIRO_CONTENT_COLOR, width, height);
+
+    cairo = cairo_create(widgets->background);
 
-    /* destroy graphics context */
+    cairo_set_source_rgb(cairo, 1, 1, 1);
+    cairo_paint(cairo);
+
+    cairo_set_source_rgb(cairo, 0.85, 0.85, 0.85);
+    cairo_set_line_width(cairo, 1);
+
+    for (i = 1; i < 4; ++i) {
+        cairo_move_to(cairo, 0, (height * i / 4) + 0.5);
+        cairo_line_to(cairo, width, (height * i / 4) + 0.5);
+        cairo_move_to(cairo, (width * i / 4) + 0.5, 0);
+        cairo_line_to(cairo, (width * i / 4) + 0.5, height);
+    }
+
+    cairo_stroke(cairo);
 
-    gdk_window_end_draw_frame(window, drawing_context);
+    cairo_destroy(cairo);
 
-    cairo_region_destroy(cairo_region);
+    return widgets->background;
 }
@@ -19,6 +19,7 @@
 typedef struct {
     GtkWindow *dialog;
     GtkWidget *envelope;
+    cairo_surface_t *background;
     GtkScale *level1;
     GtkScale *level2;
     GtkScale *level3;
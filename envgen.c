@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <math.h>
+
+#include <glib.h>
+
+#include "envgen.h"
+
+/* Offsets of the envelope parameters from PARAMETER_ENVn_LEVEL1 */
+#define ENV_LEVEL1 0
+#define ENV_LEVEL2 1
+#define ENV_LEVEL3 2
+#define ENV_VELOCITY_LEVEL 3
+#define ENV_VELOCITY_ATTACK 4
+#define ENV_TIME1 5
+#define ENV_TIME2 6
+#define ENV_TIME3 7
+#define ENV_TIME4 8
+#define ENV_KEYBOARD_DECAY_SCALING 9
+
+/* Times of 64 and above select repeating envelopes */
+#define ENV_REPEAT 64
+
+/* Key that keyboard decay scaling is relative to */
+#define ENV_SCALING_KEY 60
+
+/*
+ * Segment times in seconds for the time parameters 0 to 63, following the
+ * exponential curve 0.0227 * (exp(0.119 * time) - 1) that gives roughly 3ms
+ * for a time of 1 and 40s for a time of 63.
+ */
+static const gfloat times[64] = {
+    0.0000f, 0.0029f, 0.0061f, 0.0097f, 0.0138f, 0.0185f, 0.0237f, 0.0295f,
+    0.0361f, 0.0435f, 0.0519f, 0.0613f, 0.0720f, 0.0839f, 0.0974f, 0.1126f,
+    0.1297f, 0.1489f, 0.1706f, 0.1951f, 0.2226f, 0.2536f, 0.2885f, 0.3278f,
+    0.3721f, 0.4220f, 0.4782f, 0.5415f, 0.6128f, 0.6931f, 0.7835f, 0.8854f,
+    1.0002f, 1.1294f, 1.2750f, 1.4390f, 1.6237f, 1.8318f, 2.0661f, 2.3301f,
+    2.6274f, 2.9623f, 3.3395f, 3.7644f, 4.2430f, 4.7821f, 5.3893f, 6.0732f,
+    6.8435f, 7.7112f, 8.6885f, 9.7893f, 11.0293f, 12.4259f, 13.9990f, 15.7710f,
+    17.7668f, 20.0149f, 22.5470f, 25.3992f, 28.6117f, 32.2303f, 36.3061f, 40.8969f
+};
+
+static void envgen_stage(EnvGen *, EnvGenStage);
+
+/**
+   \brief Returns the duration of an envelope segment.
+
+   \param time - the time parameter, from 0 to 63.
+   \return the duration in seconds.
+ */
+gfloat
+envgen_time(gint time)
+{
+    return times[CLAMP(time, 0, 63)];
+}
+
+/**
+   \brief Converts the parameters of an envelope into levels and times for
+   a note.
+
+   \param params - the levels and times to fill in.
+   \param values - the parameters of the envelope, starting with level 1.
+   \param note - the MIDI note number.
+   \param velocity - the note on velocity.
+ */
+void
+envgen_params(EnvParams *params, const guchar *values, gint note, gint velocity)
+{
+    gfloat v, sensitivity, amount, scaling;
+    gint i;
+
+    v = CLAMP(velocity, 0, 127) / 127.0f;
+
+    /* velocity level values of 64 and above select an exponential curve */
+    if (values[ENV_VELOCITY_LEVEL] < 64) {
+        sensitivity = values[ENV_VELOCITY_LEVEL] / 63.0f;
+        amount = 1.0f - sensitivity * (1.0f - v);
+    } else {
+        sensitivity = (values[ENV_VELOCITY_LEVEL] - 64) / 63.0f;
+        amount = 1.0f - sensitivity * (1.0f - v * v);
+    }
+
+    for (i = 0; i < 3; ++i) {
+        params->level[i] = ((gint8) values[ENV_LEVEL1 + i]) / 63.0f * amount;
+    }
+
+    /* higher velocities shorten the attack */
+    params->time[0] = envgen_time(values[ENV_TIME1]) * (1.0f - (values[ENV_VELOCITY_ATTACK] / 63.0f) * v);
+
+    /* higher keys shorten the decays and the release */
+    scaling = 1.0f;
+    if (values[ENV_KEYBOARD_DECAY_SCALING] > 0) {
+        scaling = exp2f(-(values[ENV_KEYBOARD_DECAY_SCALING] / 63.0f) * (note - ENV_SCALING_KEY) / 12.0f);
+        scaling = CLAMP(scaling, 0.05f, 4.0f);
+    }
+
+    params->time[1] = envgen_time(values[ENV_TIME2]) * scaling;
+    params->time[2] = envgen_time(values[ENV_TIME3]) * scaling;
+    params->time[3] = envgen_time(values[ENV_TIME4] % ENV_REPEAT) * scaling;
+
+    params->repeat = values[ENV_TIME4] >= ENV_REPEAT;
+    params->full_cycle = FALSE;
+}
+
+/**
+   \brief Calculates the points of an envelope for a note held for a given
+   time after the third segment, followed by the release.
+
+   \param params - the levels and times of the envelope.
+   \param sustain - the time the note is held after the third segment.
+   \param points - the points to fill in, at least ENVGEN_MAX_POINTS
+   long.
+   \return the number of points.
+ */
+gint
+envgen_breakpoints(const EnvParams *params, gfloat sustain, EnvPoint *points)
+{
+    gfloat t, level, hold, segment;
+    gint i, n;
+
+    points[0].time = 0;
+    points[0].level = 0;
+
+    for (i = 0; i < 3; ++i) {
+        points[i + 1].time = points[i].time + params->time[i];
+        points[i + 1].level = params->level[i];
+    }
+
+    n = 4;
+    t = points[3].time;
+    level = points[3].level;
+
+    if (params->repeat && params->time[0] + params->time[1] + params->time[2] > 0) {
+        /* cycle through the first three segments while the note is held */
+        for (hold = sustain, i = 0; hold > 0 && n < ENVGEN_MAX_POINTS - 1; i = (i + 1) % 3) {
+            segment = params->time[i];
+            if (segment > hold) {
+                level += (params->level[i] - level) * hold / segment;
+                segment = hold;
+            } else {
+                level = params->level[i];
+            }
+            t += segment;
+            hold -= segment;
+            points[n].time = t;
+            points[n].level = level;
+            ++n;
+        }
+    } else {
+        t += sustain;
+        points[n].time = t;
+        points[n].level = level;
+        ++n;
+    }
+
+    points[n].time = t + params->time[3];
+    points[n].level = 0;
+
+    return n + 1;
+}
+
+/**
+   \brief Starts an envelope for a note.
+
+   \param gen - the envelope generator.
+   \param params - the levels and times for the note.
+   \param rate - the number of steps per second.
+ */
+void
+envgen_start(EnvGen *gen, const EnvParams *params, gfloat rate)
+{
+    gen->level = 0;
+
+    envgen_retrigger(gen, params, rate);
+}
+
+/**
+   \brief Restarts an envelope for a new note from its current level, as
+   happens when a voice is reassigned without voice restart.
+
+   \param gen - the envelope generator.
+   \param params - the levels and times for the note.
+   \param rate - the number of steps per second.
+ */
+void
+envgen_retrigger(EnvGen *gen, const EnvParams *params, gfloat rate)
+{
+    gen->params = *params;
+    gen->rate = rate;
+    gen->released = FALSE;
+
+    envgen_stage(gen, ENVGEN_STAGE_T1);
+}
+
+/**
+   \brief Releases an envelope, starting the fourth segment unless the
+   envelope must complete its first three segments first.
+
+   \param gen - the envelope generator.
+ */
+void
+envgen_release(EnvGen *gen)
+{
+    if (gen->released || gen->stage >= ENVGEN_STAGE_T4) {
+        return;
+    }
+
+    gen->released = TRUE;
+
+    if (!gen->params.full_cycle || gen->stage == ENVGEN_STAGE_SUSTAIN) {
+        envgen_stage(gen, ENVGEN_STAGE_T4);
+    }
+}
+
+/**
+   \brief Advances an envelope by one step.
+
+   \param gen - the envelope generator.
+   \return the level of the envelope.
+ */
+gfloat
+envgen_step(EnvGen *gen)
+{
+    switch (gen->stage) {
+    case ENVGEN_STAGE_T1:
+    case ENVGEN_STAGE_T2:
+    case ENVGEN_STAGE_T3:
+    case ENVGEN_STAGE_T4:
+        if (gen->remaining > 1) {
+            gen->level += gen->increment;
+            --gen->remaining;
+        } else {
+            gen->level = gen->target;
+            envgen_stage(gen, gen->stage + 1);
+        }
+        break;
+    case ENVGEN_STAGE_SUSTAIN:
+        if (gen->released) {
+            envgen_stage(gen, ENVGEN_STAGE_T4);
+        } else if (gen->params.repeat) {
+            envgen_stage(gen, ENVGEN_STAGE_T1);
+        }
+        break;
+    case ENVGEN_STAGE_DONE:
+        break;
+    }
+
+    return gen->level;
+}
+
+/**
+   \brief Advances an envelope by a block of steps.
+
+   \param gen - the envelope generator.
+   \param levels - the levels to fill in.
+   \param count - the number of steps.
+ */
+void
+envgen_render(EnvGen *gen, gfloat *levels, gint count)
+{
+    gint i;
+
+    for (i = 0; i < count; ++i) {
+        levels[i] = envgen_step(gen);
+    }
+}
+
+static void
+envgen_stage(EnvGen *gen, EnvGenStage stage)
+{
+    gfloat steps;
+
+    gen->stage = stage;
+
+    switch (stage) {
+    case ENVGEN_STAGE_T1:
+    case ENVGEN_STAGE_T2:
+    case ENVGEN_STAGE_T3:
+        gen->target = gen->params.level[stage];
+        steps = gen->params.time[stage] * gen->rate;
+        break;
+    case ENVGEN_STAGE_T4:
+        gen->target = 0;
+        steps = gen->params.time[3] * gen->rate;
+        break;
+    default:
+        gen->target = gen->level;
+        steps = 0;
+        break;
+    }
+
+    gen->remaining = steps < 1 ? 0 : (guint) steps;
+    gen->increment = gen->remaining ? (gen->target - gen->level) / gen->remaining : 0;
+
+    if (stage == ENVGEN_STAGE_DONE) {
+        gen->level = 0;
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ENVGEN_H
+#define ENVGEN_H
+
+/* Number of envelope parameters from PARAMETER_ENVn_LEVEL1 */
+#define ENVGEN_PARAMETER_COUNT 10
+
+/* Maximum number of points returned by envgen_breakpoints() */
+#define ENVGEN_MAX_POINTS 16
+
+typedef enum {
+    ENVGEN_STAGE_T1,
+    ENVGEN_STAGE_T2,
+    ENVGEN_STAGE_T3,
+    ENVGEN_STAGE_SUSTAIN,
+    ENVGEN_STAGE_T4,
+    ENVGEN_STAGE_DONE
+} EnvGenStage;
+
+typedef struct {
+    gfloat level[3];
+    gfloat time[4];
+    gboolean repeat;
+    gboolean full_cycle;
+} EnvParams;
+
+typedef struct {
+    gfloat time;
+    gfloat level;
+} EnvPoint;
+
+typedef struct {
+    EnvParams params;
+    EnvGenStage stage;
+    gfloat level;
+    gfloat increment;
+    gfloat target;
+    guint remaining;
+    gfloat rate;
+    gboolean released;
+} EnvGen;
+
+gfloat envgen_time(gint);
+void envgen_params(EnvParams *, const guchar *, gint, gint);
+gint envgen_breakpoints(const EnvParams *, gfloat, EnvPoint *);
+
+void envgen_start(EnvGen *, const EnvParams *, gfloat);
+void envgen_retrigger(EnvGen *, const EnvParams *, gfloat);
+void envgen_release(EnvGen *);
+gfloat envgen_step(EnvGen *);
+void envgen_render(EnvGen *, gfloat *, gint);
+
+#endif /* !ENVGEN_H */
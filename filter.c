@@ -17,67 +17,11 @@
 #include <gtk/gtk.h>
 
 #include "main.h"
+#include "parameters.h"
+#include "journal.h"
 #include "dialog.h"
 #include "filter.h"
 
-static ScaleParams resonance_params = {
-    .parameter = PARAMETER_FILTER_RESONANCE,
-    .multiplier = 4
-};
-
-static ScaleParams keyboard_tracking_params = {
-    .parameter = PARAMETER_FILTER_KEYBOARD_TRACKING,
-    .multiplier = 2
-};
-
-static ComboBoxEntry mod1_srcs[] = {
-    { "LFO 1",               PARAMETER_FILTER_MOD1_SRC, 0x00 },
-    { "LFO 2",               PARAMETER_FILTER_MOD1_SRC, 0x08 },
-    { "LFO 3",               PARAMETER_FILTER_MOD1_SRC, 0x10 },
-    { "Envelope 1",          PARAMETER_FILTER_MOD1_SRC, 0x18 },
-    { "Envelope 2",          PARAMETER_FILTER_MOD1_SRC, 0x20 },
-    { "Envelope 3",          PARAMETER_FILTER_MOD1_SRC, 0x28 },
-    { "Envelope 4",          PARAMETER_FILTER_MOD1_SRC, 0x30 },
-    { "Velocity",            PARAMETER_FILTER_MOD1_SRC, 0x38 },
-    { "Velocity X",          PARAMETER_FILTER_MOD1_SRC, 0x40 },
-    { "Keyboard",            PARAMETER_FILTER_MOD1_SRC, 0x48 },
-    { "Keyboard 2",          PARAMETER_FILTER_MOD1_SRC, 0x50 },
-    { "Modulation Wheel",    PARAMETER_FILTER_MOD1_SRC, 0x58 },
-    { "Foot Pedal",          PARAMETER_FILTER_MOD1_SRC, 0x60 },
-    { "External Controller", PARAMETER_FILTER_MOD1_SRC, 0x68 },
-    { "Pressure",            PARAMETER_FILTER_MOD1_SRC, 0x70 },
-    { "Off",                 PARAMETER_FILTER_MOD1_SRC, 0x78 }
-};
-
-static ScaleParams mod1_depth_params = {
-    .parameter = PARAMETER_FILTER_MOD1_DEPTH,
-    .offset = 64
-};
-
-static ComboBoxEntry mod2_srcs[] = {
-    { "LFO 1",               PARAMETER_FILTER_MOD2_SRC, 0x00 },
-    { "LFO 2",               PARAMETER_FILTER_MOD2_SRC, 0x08 },
-    { "LFO 3",               PARAMETER_FILTER_MOD2_SRC, 0x10 },
-    { "Envelope 1",          PARAMETER_FILTER_MOD2_SRC, 0x18 },
-    { "Envelope 2",          PARAMETER_FILTER_MOD2_SRC, 0x20 },
-    { "Envelope 3",          PARAMETER_FILTER_MOD2_SRC, 0x28 },
-    { "Envelope 4",          PARAMETER_FILTER_MOD2_SRC, 0x30 },
-    { "Velocity",            PARAMETER_FILTER_MOD2_SRC, 0x38 },
-    { "Velocity X",          PARAMETER_FILTER_MOD2_SRC, 0x40 },
-    { "Keyboard",            PARAMETER_FILTER_MOD2_SRC, 0x48 },
-    { "Keyboard 2",          PARAMETER_FILTER_MOD2_SRC, 0x50 },
-    { "Modulation Wheel",    PARAMETER_FILTER_MOD2_SRC, 0x58 },
-    { "Foot Pedal",          PARAMETER_FILTER_MOD2_SRC, 0x60 },
-    { "External Controller", PARAMETER_FILTER_MOD2_SRC, 0x68 },
-    { "Pressure",            PARAMETER_FILTER_MOD2_SRC, 0x70 },
-    { "Off",                 PARAMETER_FILTER_MOD2_SRC, 0x78 }
-};
-
-static ScaleParams mod2_depth_params = {
-    .parameter = PARAMETER_FILTER_MOD2_DEPTH,
-    .offset = 64
-};
-
 FilterDialog *
 new_filter_dialog(GtkWindow *parent)
 {
@@ -92,31 +36,31 @@ new_filter_dialog(GtkWindow *parent)
     grid = create_grid(GTK_CONTAINER(widgets->dialog));
 
     label = gtk_label_new("Frequency:");
-    widgets->frequency = create_hscale(0, 127, PARAMETER_FILTER_FREQUENCY);
+    widgets->frequency = create_hscale(PARAMETER_FILTER_FREQUENCY);
     create_grid_row(grid, 0, GTK_LABEL(label), GTK_WIDGET(widgets->frequency));
 
     label = gtk_label_new("Resonance:");
-    widgets->resonance = create_hscale_with_params(0, 31, &resonance_params);
+    widgets->resonance = create_hscale(PARAMETER_FILTER_RESONANCE);
     create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(widgets->resonance));
 
     label = gtk_label_new("Keyboard Tracking:");
-    widgets->keyboard_tracking = create_hscale_with_params(0, 63, &keyboard_tracking_params);
+    widgets->keyboard_tracking = create_hscale(PARAMETER_FILTER_KEYBOARD_TRACKING);
     create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(widgets->keyboard_tracking));
 
     label = gtk_label_new("Mod 1:");
-    widgets->mod1_src = create_combo_box_with_entries(mod1_srcs, G_N_ELEMENTS(mod1_srcs));
+    widgets->mod1_src = create_combo_box(PARAMETER_FILTER_MOD1_SRC);
     create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(widgets->mod1_src));
 
     label = gtk_label_new("Mod 1 Depth:");
-    widgets->mod1_depth = create_hscale_with_params(-63, 63, &mod1_depth_params);
+    widgets->mod1_depth = create_hscale(PARAMETER_FILTER_MOD1_DEPTH);
     create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(widgets->mod1_depth));
 
     label = gtk_label_new("Mod 2:");
-    widgets->mod2_src = create_combo_box_with_entries(mod2_srcs, G_N_ELEMENTS(mod2_srcs));
+    widgets->mod2_src = create_combo_box(PARAMETER_FILTER_MOD2_SRC);
     create_grid_row(grid, 5, GTK_LABEL(label), GTK_WIDGET(widgets->mod2_src));
 
     label = gtk_label_new("Mod 2 Depth:");
-    widgets->mod2_depth = create_hscale_with_params(-63, 63, &mod2_depth_params);
+    widgets->mod2_depth = create_hscale(PARAMETER_FILTER_MOD2_DEPTH);
     create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(widgets->mod2_depth));
 
     button_box = gtk_button_box_new(GTK_ORIENTATION_HORIZONTAL);
@@ -149,13 +93,13 @@ set_filter_parameters(FilterDialog *widgets, Patch *patch)
         patch->parameters[PARAMETER_FILTER_MOD2_SRC],
         patch->parameters[PARAMETER_FILTER_MOD2_DEPTH]);
 
-    gtk_range_set_value(GTK_RANGE(widgets->frequency), patch->parameters[PARAMETER_FILTER_FREQUENCY]);
-    gtk_range_set_value(GTK_RANGE(widgets->resonance), patch->parameters[PARAMETER_FILTER_RESONANCE]);
-    gtk_range_set_value(GTK_RANGE(widgets->keyboard_tracking), patch->parameters[PARAMETER_FILTER_KEYBOARD_TRACKING]);
+    gtk_range_set_value(GTK_RANGE(widgets->frequency), parameters_decode(PARAMETER_FILTER_FREQUENCY, patch->parameters[PARAMETER_FILTER_FREQUENCY]));
+    gtk_range_set_value(GTK_RANGE(widgets->resonance), parameters_decode(PARAMETER_FILTER_RESONANCE, patch->parameters[PARAMETER_FILTER_RESONANCE]));
+    gtk_range_set_value(GTK_RANGE(widgets->keyboard_tracking), parameters_decode(PARAMETER_FILTER_KEYBOARD_TRACKING, patch->parameters[PARAMETER_FILTER_KEYBOARD_TRACKING]));
     gtk_combo_box_set_active(GTK_COMBO_BOX(widgets->mod1_src), patch->parameters[PARAMETER_FILTER_MOD1_SRC]);
-    gtk_range_set_value(GTK_RANGE(widgets->mod1_depth), patch->parameters[PARAMETER_FILTER_MOD1_DEPTH]);
+    gtk_range_set_value(GTK_RANGE(widgets->mod1_depth), parameters_decode(PARAMETER_FILTER_MOD1_DEPTH, patch->parameters[PARAMETER_FILTER_MOD1_DEPTH]));
     gtk_combo_box_set_active(GTK_COMBO_BOX(widgets->mod2_src), patch->parameters[PARAMETER_FILTER_MOD2_SRC]);
-    gtk_range_set_value(GTK_RANGE(widgets->mod2_depth), patch->parameters[PARAMETER_FILTER_MOD2_DEPTH]);
+    gtk_range_set_value(GTK_RANGE(widgets->mod2_depth), parameters_decode(PARAMETER_FILTER_MOD2_DEPTH, patch->parameters[PARAMETER_FILTER_MOD2_DEPTH]));
 }
 
 void
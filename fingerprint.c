@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "envgen.h"
+#include "lfogen.h"
+#include "modmatrix.h"
+#include "vcf.h"
+#include "synth.h"
+#include "fingerprint.h"
+
+/* Sample rate notes are rendered at, which is plenty for comparing sounds */
+#define FP_RATE 22050
+
+/* Frames in each spectrum, and the number of spectra in a note */
+#define FP_FRAME_SIZE 1024
+#define FP_FRAME_COUNT 16
+
+/* Spectrum the note is released at */
+#define FP_RELEASE_FRAME 10
+
+#define FP_NOTE 60
+#define FP_VELOCITY 100
+
+/* Range of the mel spaced bands, in Hz */
+#define FP_LOW_FREQUENCY 150.0
+#define FP_HIGH_FREQUENCY 10000.0
+
+/* Floor for band and segment energies relative to the whole note */
+#define FP_FLOOR 1e-6
+
+/*
+ * An index file starts with the magic, then the length of a fingerprint and
+ * the number of fingerprints as little endian 32 bit numbers. The values of
+ * the fingerprints follow as little endian IEEE 754 single precision floats,
+ * then the file name of each patch, terminated by a nul.
+ */
+static const gchar magic[8] = { 'S', 'Q', '8', '0', 'F', 'P', 'I', '1' };
+
+/* Hann window, and the band of each bin of a spectrum or -1, filled in on first use */
+static gfloat window[FP_FRAME_SIZE];
+static gint bands_of_bins[FP_FRAME_SIZE / 2];
+
+static void initialise_tables(void);
+static void fft(gfloat *, gfloat *);
+static gdouble mel(gdouble);
+static gboolean write_values(const gfloat *, gsize, FILE *);
+
+/**
+   \brief Computes the fingerprint of a patch from a short note played with
+   the software voices: the shape of its spectrum in mel spaced bands, and
+   how its loudness changes over the note.
+
+   \param parameters - the parameters of the patch.
+   \param vector - the fingerprint, FINGERPRINT_LENGTH values.
+ */
+void
+fingerprint_compute(const guchar *parameters, gfloat *vector)
+{
+    Synth *synth;
+    gfloat left[FP_FRAME_SIZE], right[FP_FRAME_SIZE], re[FP_FRAME_SIZE], im[FP_FRAME_SIZE], x;
+    gdouble bands[FINGERPRINT_BANDS], segments[FINGERPRINT_SEGMENTS], total, loudest;
+    gint i, frame;
+
+    initialise_tables();
+
+    memset(bands, 0, sizeof(bands));
+    memset(segments, 0, sizeof(segments));
+
+    synth = synth_new(parameters, FP_RATE);
+    synth_note_on(synth, FP_NOTE, FP_VELOCITY);
+
+    for (frame = 0; frame < FP_FRAME_COUNT; ++frame) {
+        if (frame == FP_RELEASE_FRAME) {
+            synth_all_notes_off(synth);
+        }
+
+        memset(left, 0, sizeof(left));
+        memset(right, 0, sizeof(right));
+
+        synth_process(synth, left, right, FP_FRAME_SIZE);
+
+        for (i = 0; i < FP_FRAME_SIZE; ++i) {
+            x = (left[i] + right[i]) * 0.5f;
+            segments[frame * FINGERPRINT_SEGMENTS / FP_FRAME_COUNT] += x * x;
+            re[i] = x * window[i];
+            im[i] = 0;
+        }
+
+        fft(re, im);
+
+        for (i = 0; i < FP_FRAME_SIZE / 2; ++i) {
+            if (bands_of_bins[i] >= 0) {
+                bands[bands_of_bins[i]] += re[i] * re[i] + im[i] * im[i];
+            }
+        }
+    }
+
+    synth_free(synth);
+
+    /* the shapes are compared rather than the levels, on a log scale */
+
+    for (total = 0, i = 0; i < FINGERPRINT_BANDS; ++i) {
+        total += bands[i];
+    }
+    for (i = 0; i < FINGERPRINT_BANDS; ++i) {
+        vector[i] = total > 0 ? log10(bands[i] / total + FP_FLOOR) / 6.0 : -1.0f;
+    }
+
+    for (loudest = 0, i = 0; i < FINGERPRINT_SEGMENTS; ++i) {
+        loudest = MAX(loudest, segments[i]);
+    }
+    for (i = 0; i < FINGERPRINT_SEGMENTS; ++i) {
+        vector[FINGERPRINT_BANDS + i] = loudest > 0 ? log10(segments[i] / loudest + FP_FLOOR) / 6.0 : -1.0f;
+    }
+}
+
+/**
+   \brief Creates an empty fingerprint index.
+
+   \return the newly created index.
+ */
+FingerprintIndex *
+fingerprint_index_new(void)
+{
+    FingerprintIndex *index;
+
+    index = g_new0(FingerprintIndex, 1);
+    index->filenames = g_ptr_array_new_with_free_func(g_free);
+
+    return index;
+}
+
+/**
+   \brief Frees a fingerprint index.
+
+   \param index - the index.
+ */
+void
+fingerprint_index_free(FingerprintIndex *index)
+{
+    g_free(index->vectors);
+    g_ptr_array_free(index->filenames, TRUE);
+    g_free(index);
+}
+
+/**
+   \brief Adds the fingerprint of a patch to an index.
+
+   \param index - the index.
+   \param filename - the name of the patch file, which is copied.
+   \param vector - the fingerprint, which is copied.
+ */
+void
+fingerprint_index_add(FingerprintIndex *index, const gchar *filename, const gfloat *vector)
+{
+    if (index->count == index->capacity) {
+        index->capacity = index->capacity ? index->capacity * 2 : 256;
+        index->vectors = g_renew(gfloat, index->vectors, (gsize) index->capacity * FINGERPRINT_LENGTH);
+    }
+
+    memcpy(index->vectors + (gsize) index->count * FINGERPRINT_LENGTH, vector, FINGERPRINT_LENGTH * sizeof(gfloat));
+    g_ptr_array_add(index->filenames, g_strdup(filename));
+    ++index->count;
+}
+
+/**
+   \brief Loads a fingerprint index saved with fingerprint_index_save().
+
+   \param filename - the name of the index file.
+   \param error - set if the index can't be loaded.
+   \return the loaded index, or NULL if it can't be loaded.
+ */
+FingerprintIndex *
+fingerprint_index_load(const gchar *filename, GError **error)
+{
+    FingerprintIndex *index;
+    gchar *contents, *ptr, *end;
+    gsize length, n;
+    guint32 header[2], word;
+    guint i;
+
+    if (!g_file_get_contents(filename, &contents, &length, error)) {
+        return NULL;
+    }
+
+    if (length < sizeof(magic) + sizeof(header) || memcmp(contents, magic, sizeof(magic)) != 0) {
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "%s is not a fingerprint index", filename);
+        g_free(contents);
+        return NULL;
+    }
+
+    memcpy(header, contents + sizeof(magic), sizeof(header));
+    header[0] = GUINT32_FROM_LE(header[0]);
+    header[1] = GUINT32_FROM_LE(header[1]);
+    ptr = contents + sizeof(magic) + sizeof(header);
+    end = contents + length;
+
+    if (header[0] != FINGERPRINT_LENGTH || (gsize) (end - ptr) / (FINGERPRINT_LENGTH * sizeof(gfloat)) < header[1]) {
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "%s is an index of a different kind or is truncated", filename);
+        g_free(contents);
+        return NULL;
+    }
+
+    index = fingerprint_index_new();
+    index->count = header[1];
+    index->capacity = header[1];
+    index->vectors = g_new(gfloat, (gsize) index->count * FINGERPRINT_LENGTH);
+    memcpy(index->vectors, ptr, (gsize) index->count * FINGERPRINT_LENGTH * sizeof(gfloat));
+    for (n = 0; n < (gsize) index->count * FINGERPRINT_LENGTH; ++n) {
+        memcpy(&word, &index->vectors[n], sizeof(word));
+        word = GUINT32_FROM_LE(word);
+        memcpy(&index->vectors[n], &word, sizeof(word));
+    }
+    ptr += (gsize) index->count * FINGERPRINT_LENGTH * sizeof(gfloat);
+
+    /* the filenames follow the fingerprints, each terminated by a nul */
+    for (i = 0; i < index->count; ++i) {
+        if (ptr >= end || !memchr(ptr, '\0', end - ptr)) {
+            g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "%s is truncated", filename);
+            fingerprint_index_free(index);
+            g_free(contents);
+            return NULL;
+        }
+        g_ptr_array_add(index->filenames, g_strdup(ptr));
+        ptr += strlen(ptr) + 1;
+    }
+
+    g_free(contents);
+
+    return index;
+}
+
+/**
+   \brief Saves a fingerprint index.
+
+   \param index - the index.
+   \param filename - the name of the index file.
+   \param error - set if the index can't be saved.
+   \return whether the index was saved.
+ */
+gboolean
+fingerprint_index_save(const FingerprintIndex *index, const gchar *filename, GError **error)
+{
+    FILE *fp;
+    guint32 header[2];
+    const gchar *name;
+    guint i;
+    gint saved_errno;
+    gboolean status;
+
+    if (!(fp = fopen(filename, "wb"))) {
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errno), "%s: %s", filename, g_strerror(errno));
+        return FALSE;
+    }
+
+    header[0] = GUINT32_TO_LE(FINGERPRINT_LENGTH);
+    header[1] = GUINT32_TO_LE(index->count);
+
+    status = fwrite(magic, sizeof(magic), 1, fp) == 1
+        && fwrite(header, sizeof(header), 1, fp) == 1
+        && write_values(index->vectors, (gsize) index->count * FINGERPRINT_LENGTH, fp);
+
+    for (i = 0; status && i < index->count; ++i) {
+        name = g_ptr_array_index(index->filenames, i);
+        status = fwrite(name, strlen(name) + 1, 1, fp) == 1;
+    }
+
+    saved_errno = errno;
+
+    if (fclose(fp) != 0 && status) {
+        status = FALSE;
+        saved_errno = errno;
+    }
+
+    if (!status) {
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(saved_errno), "%s: %s", filename, g_strerror(saved_errno));
+    }
+
+    return status;
+}
+
+/**
+   \brief Finds the fingerprints in an index closest to a fingerprint. The
+   whole index is scanned, as a flat array of fingerprints, with a loop the
+   compiler can vectorise.
+
+   \param index - the index.
+   \param vector - the fingerprint to match.
+   \param matches - the closest matches, closest first.
+   \param count - the greatest number of matches to find.
+   \return the number of matches found.
+ */
+gint
+fingerprint_index_search(const FingerprintIndex *index, const gfloat *vector, FingerprintMatch *matches, gint count)
+{
+    const gfloat *v;
+    gfloat distance, x;
+    guint i;
+    gint j, found;
+
+    if (count < 1) {
+        return 0;
+    }
+
+    for (found = 0, i = 0; i < index->count; ++i) {
+        v = index->vectors + (gsize) i * FINGERPRINT_LENGTH;
+
+        distance = 0;
+        for (j = 0; j < FINGERPRINT_LENGTH; ++j) {
+            x = v[j] - vector[j];
+            distance += x * x;
+        }
+
+        if (found == count && distance >= matches[found - 1].distance) {
+            continue;
+        }
+
+        /* insert into the sorted matches, dropping the furthest if they're full */
+        j = found < count ? found++ : found - 1;
+        for (; j > 0 && matches[j - 1].distance > distance; --j) {
+            matches[j] = matches[j - 1];
+        }
+        matches[j].index = i;
+        matches[j].distance = distance;
+    }
+
+    return found;
+}
+
+static void
+initialise_tables(void)
+{
+    static gsize initialised = 0;
+    gdouble low, high, hz;
+    gint i, band;
+
+    if (g_once_init_enter(&initialised)) {
+        for (i = 0; i < FP_FRAME_SIZE; ++i) {
+            window[i] = 0.5 - 0.5 * cos(2.0 * G_PI * i / FP_FRAME_SIZE);
+        }
+
+        low = mel(FP_LOW_FREQUENCY);
+        high = mel(FP_HIGH_FREQUENCY);
+
+        for (i = 0; i < FP_FRAME_SIZE / 2; ++i) {
+            hz = (gdouble) i * FP_RATE / FP_FRAME_SIZE;
+            band = floor((mel(hz) - low) / (high - low) * FINGERPRINT_BANDS);
+            bands_of_bins[i] = band >= 0 && band < FINGERPRINT_BANDS ? band : -1;
+        }
+
+        g_once_init_leave(&initialised, 1);
+    }
+}
+
+/*
+ * Transforms a frame in place with an iterative radix 2 FFT.
+ */
+static void
+fft(gfloat *re, gfloat *im)
+{
+    gfloat wr, wi, tr, ti, ur, ui, t;
+    gint i, j, k, n, half;
+
+    for (i = 1, j = 0; i < FP_FRAME_SIZE; ++i) {
+        for (k = FP_FRAME_SIZE >> 1; j & k; k >>= 1) {
+            j ^= k;
+        }
+        j |= k;
+        if (i < j) {
+            t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+
+    for (n = 2; n <= FP_FRAME_SIZE; n <<= 1) {
+        half = n >> 1;
+        for (k = 0; k < half; ++k) {
+            wr = cosf(-2.0f * G_PI * k / n);
+            wi = sinf(-2.0f * G_PI * k / n);
+            for (i = k; i < FP_FRAME_SIZE; i += n) {
+                j = i + half;
+                tr = wr * re[j] - wi * im[j];
+                ti = wr * im[j] + wi * re[j];
+                ur = re[i];
+                ui = im[i];
+                re[i] = ur + tr;
+                im[i] = ui + ti;
+                re[j] = ur - tr;
+                im[j] = ui - ti;
+            }
+        }
+    }
+}
+
+static gdouble
+mel(gdouble hz)
+{
+    return 2595.0 * log10(1.0 + hz / 700.0);
+}
+
+/*
+ * Writes floats in little endian order, converting them one at a time only
+ * on a big endian machine.
+ */
+static gboolean
+write_values(const gfloat *values, gsize count, FILE *fp)
+{
+    guint32 word;
+    gsize i;
+
+    if (G_BYTE_ORDER == G_LITTLE_ENDIAN) {
+        return fwrite(values, sizeof(gfloat), count, fp) == count;
+    }
+
+    for (i = 0; i < count; ++i) {
+        memcpy(&word, &values[i], sizeof(word));
+        word = GUINT32_TO_LE(word);
+        if (fwrite(&word, sizeof(word), 1, fp) != 1) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+/* Number of mel spaced bands in a fingerprint */
+#define FINGERPRINT_BANDS 24
+
+/* Number of loudness segments in a fingerprint */
+#define FINGERPRINT_SEGMENTS 8
+
+#define FINGERPRINT_LENGTH (FINGERPRINT_BANDS + FINGERPRINT_SEGMENTS)
+
+/* Name of the index kept next to a library of patches */
+#define FINGERPRINT_INDEX_NAME "fingerprints.idx"
+
+typedef struct {
+    guint index;
+    gfloat distance;
+} FingerprintMatch;
+
+typedef struct {
+    guint count;
+    guint capacity;
+    gfloat *vectors;
+    GPtrArray *filenames;
+} FingerprintIndex;
+
+void fingerprint_compute(const guchar *, gfloat *);
+
+FingerprintIndex *fingerprint_index_new(void);
+void fingerprint_index_free(FingerprintIndex *);
+void fingerprint_index_add(FingerprintIndex *, const gchar *, const gfloat *);
+FingerprintIndex *fingerprint_index_load(const gchar *, GError **);
+gboolean fingerprint_index_save(const FingerprintIndex *, const gchar *, GError **);
+gint fingerprint_index_search(const FingerprintIndex *, const gfloat *, FingerprintMatch *, gint);
+
+#endif /* !FINGERPRINT_H */
@@ -0,0 +1,583 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "history.h"
+
+/* Kinds of record, each preceded by its length as 16 bits */
+#define RECORD_KEY 0
+#define RECORD_SNAPSHOT 1
+#define RECORD_DELTA 2
+
+/* Bytes in the length of a record */
+#define RECORD_HEADER 2
+
+/* Bytes in the kind, key number and time of a revision */
+#define REVISION_HEADER 7
+
+/* Greatest length of a revision, a delta changing everything */
+#define REVISION_MAX_LENGTH (REVISION_HEADER + 1 + 2 * (1 + G_MAXUINT8) + 1 + 2 * PARAMETER_COUNT)
+
+/* Flags of a delta, saying whether the name and type follow */
+#define DELTA_NAME 0x01
+#define DELTA_TYPE 0x02
+
+static const gchar magic[8] = { 'S', 'Q', '8', '0', 'H', 'I', 'S', '1' };
+
+static HistoryEntry *entry_new(guint16);
+static void entry_free(gpointer);
+static gboolean load_record(History *, const guchar *, gsize, gint64);
+static gboolean apply_revision(HistoryEntry *, const guchar *, const guchar *);
+static gboolean get_string(const guchar **, const guchar *, const guchar **, guint *);
+static guint start_record(GByteArray *, guchar);
+static void end_record(GByteArray *, guint);
+static void put_string(GByteArray *, const gchar *);
+static void put16(GByteArray *, guint16);
+static void put32(GByteArray *, guint32);
+static guint16 get16(const guchar *);
+static guint32 get32(const guchar *);
+
+/**
+   \brief Opens the history of a library of patches, reading the file once
+   to index the revisions of every patch in it. A history that doesn't
+   exist yet is opened empty, and is created when a revision is added.
+
+   \param filename - the name of the history file.
+   \param error - set if the history can't be read.
+   \return the history, or NULL if it can't be read.
+ */
+History *
+history_open(const gchar *filename, GError **error)
+{
+    History *history;
+    GError *local_error = NULL;
+    gchar *contents;
+    const guchar *start, *ptr, *end;
+    gsize length;
+
+    history = g_new(History, 1);
+    history->filename = g_strdup(filename);
+    history->length = 0;
+    history->entries = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, entry_free);
+    history->keys = g_ptr_array_new_with_free_func(g_free);
+
+    if (!g_file_get_contents(filename, &contents, &length, &local_error)) {
+        if (g_error_matches(local_error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+            g_error_free(local_error);
+            return history;
+        }
+        g_propagate_error(error, local_error);
+        history_free(history);
+        return NULL;
+    }
+
+    if (length > 0 && (length < sizeof(magic) || memcmp(contents, magic, sizeof(magic)) != 0)) {
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "%s is not a patch history", filename);
+        g_free(contents);
+        history_free(history);
+        return NULL;
+    }
+
+    if (length > 0) {
+        start = (const guchar *) contents;
+        ptr = start + sizeof(magic);
+        end = start + length;
+
+        /* a record cut short, as by a crash while saving, ends the history */
+        while (end - ptr >= RECORD_HEADER && end - ptr - RECORD_HEADER >= get16(ptr)
+            && load_record(history, ptr + RECORD_HEADER, get16(ptr), ptr - start)) {
+            ptr += RECORD_HEADER + get16(ptr);
+        }
+
+        history->length = ptr - start;
+    }
+
+    g_free(contents);
+
+    return history;
+}
+
+/**
+   \brief Frees a history.
+
+   \param history - the history to free.
+ */
+void
+history_free(History *history)
+{
+    g_hash_table_destroy(history->entries);
+    g_ptr_array_free(history->keys, TRUE);
+    g_free(history->filename);
+    g_free(history);
+}
+
+/**
+   \brief Adds a revision of a patch to the end of a history. The revision
+   is a full snapshot of the patch every HISTORY_SNAPSHOT_INTERVAL revisions,
+   and otherwise holds only what changed since the revision before it.
+   Nothing is added if the patch hasn't changed.
+
+   \param history - the history.
+   \param key - the name of the patch file, without its directory.
+   \param patch - the patch.
+   \param error - set if the revision can't be written.
+   \return whether the revision was written.
+ */
+gboolean
+history_append(History *history, const gchar *key, const Patch *patch, GError **error)
+{
+    HistoryEntry *entry;
+    GByteArray *bytes;
+    FILE *fp;
+    guint start, count, i;
+    guchar flags, byte;
+    gboolean status;
+
+    entry = g_hash_table_lookup(history->entries, key);
+
+    bytes = g_byte_array_new();
+
+    if (history->length == 0) {
+        g_byte_array_append(bytes, (const guint8 *) magic, sizeof(magic));
+    }
+
+    if (!entry) {
+        if (history->keys->len > G_MAXUINT16) {
+            g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_NOSPC, "%s holds too many patches", history->filename);
+            g_byte_array_free(bytes, TRUE);
+            return FALSE;
+        }
+        start = start_record(bytes, RECORD_KEY);
+        g_byte_array_append(bytes, (const guint8 *) key, MIN(strlen(key), G_MAXUINT16 - 1));
+        end_record(bytes, start);
+    }
+
+    if (!entry || entry->revisions->len % HISTORY_SNAPSHOT_INTERVAL == 0) {
+        start = start_record(bytes, RECORD_SNAPSHOT);
+        put16(bytes, entry ? entry->id : history->keys->len);
+        put32(bytes, g_get_real_time() / G_USEC_PER_SEC);
+        put_string(bytes, patch->name);
+        put_string(bytes, patch->type);
+        g_byte_array_append(bytes, patch->parameters, PARAMETER_COUNT);
+        end_record(bytes, start);
+    } else {
+        for (count = 0, i = 0; i < PARAMETER_COUNT; ++i) {
+            count += entry->parameters[i] != patch->parameters[i];
+        }
+
+        flags = 0;
+        if (strcmp(entry->name, patch->name) != 0) {
+            flags |= DELTA_NAME;
+        }
+        if (strcmp(entry->type, patch->type) != 0) {
+            flags |= DELTA_TYPE;
+        }
+
+        if (count == 0 && flags == 0) {
+            g_byte_array_free(bytes, TRUE);
+            return TRUE;
+        }
+
+        start = start_record(bytes, RECORD_DELTA);
+        put16(bytes, entry->id);
+        put32(bytes, g_get_real_time() / G_USEC_PER_SEC);
+        g_byte_array_append(bytes, &flags, 1);
+        if (flags & DELTA_NAME) {
+            put_string(bytes, patch->name);
+        }
+        if (flags & DELTA_TYPE) {
+            put_string(bytes, patch->type);
+        }
+        byte = count;
+        g_byte_array_append(bytes, &byte, 1);
+        for (i = 0; i < PARAMETER_COUNT; ++i) {
+            if (entry->parameters[i] != patch->parameters[i]) {
+                byte = i;
+                g_byte_array_append(bytes, &byte, 1);
+                g_byte_array_append(bytes, &patch->parameters[i], 1);
+            }
+        }
+        end_record(bytes, start);
+    }
+
+    if (!(fp = fopen(history->filename, "r+b")) && (errno != ENOENT || !(fp = fopen(history->filename, "w+b")))) {
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errno), "%s: %s", history->filename, g_strerror(errno));
+        g_byte_array_free(bytes, TRUE);
+        return FALSE;
+    }
+
+    /* overwrite any record cut short, so the new records can be read */
+    status = fseek(fp, history->length, SEEK_SET) == 0
+        && fwrite(bytes->data, bytes->len, 1, fp) == 1
+        && fflush(fp) == 0
+        && ftruncate(fileno(fp), history->length + bytes->len) == 0;
+
+    if (fclose(fp) != 0) {
+        status = FALSE;
+    }
+
+    if (!status) {
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errno), "%s: %s", history->filename, g_strerror(errno));
+        g_byte_array_free(bytes, TRUE);
+        return FALSE;
+    }
+
+    /* index the new records just as they would be read back */
+    i = history->length == 0 ? sizeof(magic) : 0;
+
+    while (i < bytes->len) {
+        load_record(history, bytes->data + i + RECORD_HEADER, get16(bytes->data + i), history->length + i);
+        i += RECORD_HEADER + get16(bytes->data + i);
+    }
+
+    history->length += bytes->len;
+
+    g_byte_array_free(bytes, TRUE);
+
+    return TRUE;
+}
+
+/**
+   \brief Gets the revisions of a patch in a history, oldest first.
+
+   \param history - the history.
+   \param key - the name of the patch file, without its directory.
+   \param count - set to the number of revisions.
+   \return the revisions, or NULL if there are none.
+ */
+const HistoryRevision *
+history_revisions(const History *history, const gchar *key, guint *count)
+{
+    HistoryEntry *entry;
+
+    if (!(entry = g_hash_table_lookup(history->entries, key))) {
+        *count = 0;
+        return NULL;
+    }
+
+    *count = entry->revisions->len;
+
+    return (const HistoryRevision *) entry->revisions->data;
+}
+
+/**
+   \brief Reads a revision of a patch, from the snapshot before it and the
+   deltas between the two.
+
+   \param history - the history.
+   \param key - the name of the patch file, without its directory.
+   \param revision - the number of the revision, counting from 0.
+   \param parameters - the parameters to fill in.
+   \param name - set to the name of the patch, if not NULL.
+   \param type - set to the type of the patch, if not NULL.
+   \param error - set if the revision can't be read.
+   \return whether the revision was read.
+ */
+gboolean
+history_read(const History *history, const gchar *key, guint revision, guchar *parameters, gchar **name, gchar **type, GError **error)
+{
+    HistoryEntry *entry, *state;
+    const HistoryRevision *revisions;
+    FILE *fp;
+    guchar buffer[REVISION_MAX_LENGTH];
+    gsize length;
+    guint count, i;
+    gboolean status;
+
+    revisions = history_revisions(history, key, &count);
+
+    if (revision >= count) {
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "%s has no revision %u of %s", history->filename, revision, key);
+        return FALSE;
+    }
+
+    if (!(fp = fopen(history->filename, "rb"))) {
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errno), "%s: %s", history->filename, g_strerror(errno));
+        return FALSE;
+    }
+
+    entry = g_hash_table_lookup(history->entries, key);
+    state = entry_new(entry->id);
+
+    status = TRUE;
+
+    for (i = revisions[revision].snapshot; status && i <= revision; ++i) {
+        status = fseek(fp, revisions[i].offset, SEEK_SET) == 0
+            && fread(buffer, RECORD_HEADER, 1, fp) == 1
+            && (length = get16(buffer)) <= sizeof(buffer)
+            && fread(buffer, length, 1, fp) == 1
+            && apply_revision(state, buffer, buffer + length);
+    }
+
+    fclose(fp);
+
+    if (status) {
+        memcpy(parameters, state->parameters, PARAMETER_COUNT);
+        if (name) {
+            *name = g_strdup(state->name);
+        }
+        if (type) {
+            *type = g_strdup(state->type);
+        }
+    } else {
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "%s has changed since it was opened", history->filename);
+    }
+
+    entry_free(state);
+
+    return status;
+}
+
+/*
+ * Creates the entry for a patch with no revisions.
+ */
+static HistoryEntry *
+entry_new(guint16 id)
+{
+    HistoryEntry *entry;
+
+    entry = g_new0(HistoryEntry, 1);
+    entry->id = id;
+    entry->revisions = g_array_new(FALSE, FALSE, sizeof(HistoryRevision));
+    entry->name = g_strdup("");
+    entry->type = g_strdup("");
+
+    return entry;
+}
+
+static void
+entry_free(gpointer data)
+{
+    HistoryEntry *entry = data;
+
+    g_array_free(entry->revisions, TRUE);
+    g_free(entry->name);
+    g_free(entry->type);
+    g_free(entry);
+}
+
+/*
+ * Adds a record to the index of a history, returning FALSE if it isn't a
+ * record that can follow those already indexed.
+ */
+static gboolean
+load_record(History *history, const guchar *record, gsize length, gint64 offset)
+{
+    HistoryEntry *entry;
+    HistoryRevision revision;
+    gchar *key;
+    guint16 id;
+
+    if (length == 0) {
+        return FALSE;
+    }
+
+    if (record[0] == RECORD_KEY) {
+        key = g_strndup((const gchar *) record + 1, length - 1);
+        if (history->keys->len > G_MAXUINT16 || g_hash_table_contains(history->entries, key)) {
+            g_free(key);
+            return FALSE;
+        }
+        g_ptr_array_add(history->keys, key);
+        g_hash_table_insert(history->entries, key, entry_new(history->keys->len - 1));
+        return TRUE;
+    }
+
+    if ((record[0] != RECORD_SNAPSHOT && record[0] != RECORD_DELTA) || length < REVISION_HEADER
+        || (id = get16(record + 1)) >= history->keys->len) {
+        return FALSE;
+    }
+
+    entry = g_hash_table_lookup(history->entries, g_ptr_array_index(history->keys, id));
+
+    if ((record[0] == RECORD_DELTA && entry->revisions->len == 0) || !apply_revision(entry, record, record + length)) {
+        return FALSE;
+    }
+
+    revision.offset = offset;
+    revision.time = get32(record + 3);
+    revision.snapshot = record[0] == RECORD_SNAPSHOT ? entry->revisions->len
+        : g_array_index(entry->revisions, HistoryRevision, entry->revisions->len - 1).snapshot;
+    g_array_append_val(entry->revisions, revision);
+
+    return TRUE;
+}
+
+/*
+ * Applies a snapshot or delta to the state of a patch, leaving the state
+ * unchanged if the revision is malformed.
+ */
+static gboolean
+apply_revision(HistoryEntry *state, const guchar *ptr, const guchar *end)
+{
+    const guchar *name = NULL, *type = NULL;
+    guint name_length = 0, type_length = 0;
+    guchar kind, flags;
+    gint i;
+
+    if (end - ptr < REVISION_HEADER) {
+        return FALSE;
+    }
+
+    kind = ptr[0];
+    ptr += REVISION_HEADER;
+
+    if (kind == RECORD_DELTA) {
+        if (ptr == end) {
+            return FALSE;
+        }
+        flags = *ptr++;
+    } else {
+        flags = DELTA_NAME | DELTA_TYPE;
+    }
+
+    if (((flags & DELTA_NAME) && !get_string(&ptr, end, &name, &name_length))
+        || ((flags & DELTA_TYPE) && !get_string(&ptr, end, &type, &type_length))) {
+        return FALSE;
+    }
+
+    if (kind == RECORD_SNAPSHOT) {
+        if (end - ptr != PARAMETER_COUNT) {
+            return FALSE;
+        }
+        memcpy(state->parameters, ptr, PARAMETER_COUNT);
+    } else {
+        /* a count of parameters, then a number and value for each */
+        if (ptr == end || end - ptr != 1 + 2 * ptr[0]) {
+            return FALSE;
+        }
+        for (i = 1; i < end - ptr; i += 2) {
+            if (ptr[i] >= PARAMETER_COUNT) {
+                return FALSE;
+            }
+        }
+        for (i = 1; i < end - ptr; i += 2) {
+            state->parameters[ptr[i]] = ptr[i + 1];
+        }
+    }
+
+    if (flags & DELTA_NAME) {
+        g_free(state->name);
+        state->name = g_strndup((const gchar *) name, name_length);
+    }
+
+    if (flags & DELTA_TYPE) {
+        g_free(state->type);
+        state->type = g_strndup((const gchar *) type, type_length);
+    }
+
+    return TRUE;
+}
+
+/*
+ * Gets a string of up to 255 bytes preceded by its length.
+ */
+static gboolean
+get_string(const guchar **ptr, const guchar *end, const guchar **string, guint *length)
+{
+    if (*ptr == end || end - *ptr - 1 < **ptr) {
+        return FALSE;
+    }
+
+    *length = **ptr;
+    *string = *ptr + 1;
+    *ptr += 1 + *length;
+
+    return TRUE;
+}
+
+/*
+ * Starts a record of a kind, returning where it starts so its length can
+ * be filled in when it ends.
+ */
+static guint
+start_record(GByteArray *bytes, guchar kind)
+{
+    guint start;
+
+    start = bytes->len;
+    put16(bytes, 0);
+    g_byte_array_append(bytes, &kind, 1);
+
+    return start;
+}
+
+static void
+end_record(GByteArray *bytes, guint start)
+{
+    guint16 length;
+
+    length = GUINT16_TO_LE(bytes->len - start - RECORD_HEADER);
+    memcpy(bytes->data + start, &length, sizeof(length));
+}
+
+/*
+ * Puts a string preceded by its length, cutting it to 255 bytes.
+ */
+static void
+put_string(GByteArray *bytes, const gchar *string)
+{
+    guchar length;
+
+    length = MIN(strlen(string), G_MAXUINT8);
+    g_byte_array_append(bytes, &length, 1);
+    g_byte_array_append(bytes, (const guint8 *) string, length);
+}
+
+/*
+ * Numbers are kept little endian, so a history can be moved between
+ * machines along with its library.
+ */
+static void
+put16(GByteArray *bytes, guint16 value)
+{
+    value = GUINT16_TO_LE(value);
+    g_byte_array_append(bytes, (const guint8 *) &value, sizeof(value));
+}
+
+static void
+put32(GByteArray *bytes, guint32 value)
+{
+    value = GUINT32_TO_LE(value);
+    g_byte_array_append(bytes, (const guint8 *) &value, sizeof(value));
+}
+
+static guint16
+get16(const guchar *ptr)
+{
+    guint16 value;
+
+    memcpy(&value, ptr, sizeof(value));
+
+    return GUINT16_FROM_LE(value);
+}
+
+static guint32
+get32(const guchar *ptr)
+{
+    guint32 value;
+
+    memcpy(&value, ptr, sizeof(value));
+
+    return GUINT32_FROM_LE(value);
+}
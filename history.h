@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+/* Name of the history kept next to a library of patches */
+#define HISTORY_NAME "history.log"
+
+/* Number of revisions of a patch from one full snapshot to the next */
+#define HISTORY_SNAPSHOT_INTERVAL 16
+
+typedef struct {
+    gint64 offset;
+    guint32 time;
+    guint snapshot;
+} HistoryRevision;
+
+typedef struct {
+    guint16 id;
+    GArray *revisions;
+    gchar *name;
+    gchar *type;
+    guchar parameters[PARAMETER_COUNT];
+} HistoryEntry;
+
+typedef struct {
+    gchar *filename;
+    gint64 length;
+    GHashTable *entries;
+    GPtrArray *keys;
+} History;
+
+History *history_open(const gchar *, GError **);
+void history_free(History *);
+gboolean history_append(History *, const gchar *, const Patch *, GError **);
+const HistoryRevision *history_revisions(const History *, const gchar *, guint *);
+gboolean history_read(const History *, const gchar *, guint, guchar *, gchar **, gchar **, GError **);
+
+#endif /* !HISTORY_H */
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "parameters.h"
+#include "journal.h"
+#include "dialog.h"
+#include "history.h"
+#include "historydialog.h"
+
+enum { REVISION_COL, SAVED_COL, REVISION_NAME_COL, REVISION_NCOLS };
+
+/*
+ * Lists the saved revisions of a patch, newest first, and restores the
+ * settings of the chosen one. Restoring is recorded in the journal, so it
+ * can be undone. Returns whether the patch was restored, so the caller can
+ * show its new values.
+ */
+gboolean
+run_history_dialog(GtkWindow *parent, History *history, Patch *patch, Journal *journal)
+{
+    GtkWidget *dialog, *scrolled_window, *tree_view;
+    GtkListStore *store;
+    GtkTreeSelection *selection;
+    GtkTreeViewColumn *column;
+    GtkCellRenderer *renderer;
+    GtkTreeModel *model;
+    GtkTreeIter iter;
+    GDateTime *date_time;
+    const HistoryRevision *revisions;
+    GError *error = NULL;
+    gchar *key, *saved, *name;
+    guchar parameters[PARAMETER_COUNT];
+    gboolean restored;
+    guint count, revision;
+    gint i;
+
+    count = 0;
+    key = NULL;
+    revisions = NULL;
+
+    if (history && patch->filename) {
+        key = g_path_get_basename(patch->filename);
+        revisions = history_revisions(history, key, &count);
+    }
+
+    if (count == 0) {
+        dialog = gtk_message_dialog_new(parent,
+            GTK_DIALOG_MODAL,
+            GTK_MESSAGE_INFO,
+            GTK_BUTTONS_CLOSE,
+            "%s has no saved revisions", patch->name);
+        gtk_dialog_run(GTK_DIALOG(dialog));
+        gtk_widget_destroy(dialog);
+        g_free(key);
+        return FALSE;
+    }
+
+    store = gtk_list_store_new(REVISION_NCOLS, G_TYPE_UINT, G_TYPE_STRING, G_TYPE_STRING);
+
+    for (revision = count; revision-- > 0;) {
+        if (!history_read(history, key, revision, parameters, &name, NULL, &error)) {
+            g_print("Unable to read %s:\n%s\n", history->filename, error->message);
+            g_clear_error(&error);
+            break;
+        }
+
+        date_time = g_date_time_new_from_unix_local(revisions[revision].time);
+        saved = g_date_time_format(date_time, "%Y-%m-%d %H:%M:%S");
+        g_date_time_unref(date_time);
+
+        gtk_list_store_append(store, &iter);
+        gtk_list_store_set(store, &iter,
+            REVISION_COL, revision + 1,
+            SAVED_COL, saved,
+            REVISION_NAME_COL, name,
+            -1);
+
+        g_free(saved);
+        g_free(name);
+    }
+
+    dialog = gtk_dialog_new_with_buttons("History",
+        parent,
+        GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+        "_Restore", GTK_RESPONSE_ACCEPT,
+        "_Close", GTK_RESPONSE_CLOSE,
+        NULL);
+    gtk_window_set_default_size(GTK_WINDOW(dialog), -1, 300);
+
+    scrolled_window = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_shadow_type(GTK_SCROLLED_WINDOW(scrolled_window), GTK_SHADOW_ETCHED_IN);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled_window), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_box_pack_start(GTK_BOX(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), scrolled_window, TRUE, TRUE, 0);
+
+    tree_view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(store));
+    g_object_unref(store);
+    g_signal_connect(G_OBJECT(tree_view), "row-activated", G_CALLBACK(activate_row_callback), dialog);
+    gtk_container_add(GTK_CONTAINER(scrolled_window), tree_view);
+
+    renderer = gtk_cell_renderer_text_new();
+    column = gtk_tree_view_column_new_with_attributes("Revision", renderer, "text", REVISION_COL, NULL);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view), column);
+
+    renderer = gtk_cell_renderer_text_new();
+    column = gtk_tree_view_column_new_with_attributes("Saved", renderer, "text", SAVED_COL, NULL);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view), column);
+
+    renderer = gtk_cell_renderer_text_new();
+    column = gtk_tree_view_column_new_with_attributes("Name", renderer, "text", REVISION_NAME_COL, NULL);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view), column);
+
+    gtk_widget_show_all(scrolled_window);
+
+    restored = FALSE;
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(tree_view));
+
+        if (gtk_tree_selection_get_selected(selection, &model, &iter)) {
+            gtk_tree_model_get(model, &iter, REVISION_COL, &revision, -1);
+
+            if (history_read(history, key, revision - 1, parameters, NULL, NULL, &error)) {
+                /* the whole restore is undone in one step */
+                journal_begin_group(journal);
+                for (i = 0; i < PARAMETER_COUNT; ++i) {
+                    if (patch->parameters[i] != parameters[i]) {
+                        journal_record(journal, patch, i, patch->parameters[i], parameters[i]);
+                        patch->parameters[i] = parameters[i];
+                        queue_parameter(i, parameters_encode(i, parameters[i]));
+                    }
+                }
+                journal_end_group(journal);
+
+                restored = TRUE;
+            } else {
+                g_print("Unable to read %s:\n%s\n", history->filename, error->message);
+                g_error_free(error);
+            }
+        }
+    }
+
+    gtk_widget_destroy(dialog);
+    g_free(key);
+
+    return restored;
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "journal.h"
+
+static JournalRecord *get_record(Journal *, guint);
+
+/**
+   \brief Creates an empty journal of parameter edits. The records are held
+   in a ring allocated once, so a journal never grows however long the
+   editing session.
+
+   \return the journal.
+ */
+Journal *
+journal_new(void)
+{
+    Journal *journal;
+
+    journal = g_new0(Journal, 1);
+    journal->records = g_new(JournalRecord, JOURNAL_CAPACITY);
+
+    return journal;
+}
+
+/**
+   \brief Frees a journal of parameter edits.
+
+   \param journal - the journal to free.
+ */
+void
+journal_free(Journal *journal)
+{
+    g_free(journal->records);
+    g_free(journal);
+}
+
+/**
+   \brief Records an edit of a parameter, forgetting any edits that were
+   undone. Changes to the same parameter in quick succession, as when a
+   slider is dragged, are merged into one edit.
+
+   \param journal - the journal.
+   \param patch - the edited patch.
+   \param parameter - the edited parameter.
+   \param old_value - the value before the edit.
+   \param new_value - the value after the edit.
+ */
+void
+journal_record(Journal *journal, Patch *patch, gint parameter, guchar old_value, guchar new_value)
+{
+    JournalRecord *record;
+    gint64 now;
+
+    now = g_get_monotonic_time();
+
+    journal->count = journal->done;
+
+    if (!journal->grouping && journal->mergeable && journal->done > 0 && now - journal->last_time < JOURNAL_MERGE_INTERVAL) {
+        record = get_record(journal, journal->done - 1);
+
+        if (record->patch == patch && record->parameter == parameter) {
+            record->new_value = new_value;
+
+            /* a drag back to where it started is no edit at all */
+            if (record->new_value == record->old_value) {
+                --journal->count;
+                --journal->done;
+                journal->mergeable = FALSE;
+            } else {
+                journal->last_time = now;
+            }
+            return;
+        }
+    }
+
+    /* when full, the oldest edit makes way */
+    if (journal->count == JOURNAL_CAPACITY) {
+        journal->first = (journal->first + 1) % JOURNAL_CAPACITY;
+        --journal->count;
+        --journal->done;
+        get_record(journal, 0)->grouped = FALSE;
+    }
+
+    record = get_record(journal, journal->count);
+    record->patch = patch;
+    record->parameter = (guchar) parameter;
+    record->old_value = old_value;
+    record->new_value = new_value;
+
+    /* a group holds each parameter of one patch at most once */
+    if (journal->grouping && journal->group_size == PARAMETER_COUNT) {
+        journal->group_size = 0;
+    }
+    record->grouped = journal->grouping && journal->group_size > 0;
+    if (journal->grouping) {
+        ++journal->group_size;
+    }
+
+    ++journal->count;
+    ++journal->done;
+
+    journal->last_time = now;
+    journal->mergeable = !journal->grouping;
+}
+
+/**
+   \brief Starts a group of edits, such as restoring a patch, that is undone
+   and redone as one. Edits in a group are never merged.
+
+   \param journal - the journal.
+ */
+void
+journal_begin_group(Journal *journal)
+{
+    journal->grouping = TRUE;
+    journal->group_size = 0;
+    journal->mergeable = FALSE;
+}
+
+/**
+   \brief Ends a group of edits.
+
+   \param journal - the journal.
+ */
+void
+journal_end_group(Journal *journal)
+{
+    journal->grouping = FALSE;
+    journal->mergeable = FALSE;
+}
+
+/**
+   \brief Steps back over the last edit, or the last group of edits.
+
+   \param journal - the journal.
+   \param records - filled in with the edits, newest first, whose old
+   values should be restored. There are at most PARAMETER_COUNT.
+   \return the number of edits, or 0 if there are no edits to undo.
+ */
+gint
+journal_undo(Journal *journal, const JournalRecord **records)
+{
+    JournalRecord *record;
+    gint n;
+
+    journal->mergeable = FALSE;
+
+    for (n = 0; journal->done > 0; ) {
+        record = get_record(journal, --journal->done);
+        records[n++] = record;
+
+        if (!record->grouped) {
+            break;
+        }
+    }
+
+    return n;
+}
+
+/**
+   \brief Steps forward over the last edit, or group of edits, undone.
+
+   \param journal - the journal.
+   \param records - filled in with the edits, oldest first, whose new
+   values should be restored. There are at most PARAMETER_COUNT.
+   \return the number of edits, or 0 if there are no edits to redo.
+ */
+gint
+journal_redo(Journal *journal, const JournalRecord **records)
+{
+    gint n;
+
+    journal->mergeable = FALSE;
+
+    for (n = 0; journal->done < journal->count; ) {
+        records[n++] = get_record(journal, journal->done++);
+
+        if (journal->done == journal->count || !get_record(journal, journal->done)->grouped) {
+            break;
+        }
+    }
+
+    return n;
+}
+
+/**
+   \brief Forgets the edits of a patch, such as when it is closed.
+
+   \param journal - the journal.
+   \param patch - the patch.
+ */
+void
+journal_forget(Journal *journal, Patch *patch)
+{
+    JournalRecord *record;
+    guint i, kept, done;
+
+    kept = 0;
+    done = 0;
+
+    for (i = 0; i < journal->count; ++i) {
+        record = get_record(journal, i);
+
+        if (record->patch != patch) {
+            *get_record(journal, kept++) = *record;
+            if (i < journal->done) {
+                ++done;
+            }
+        }
+    }
+
+    journal->count = kept;
+    journal->done = done;
+    journal->mergeable = FALSE;
+}
+
+/*
+ * Returns a record by its position from the oldest.
+ */
+static JournalRecord *
+get_record(Journal *journal, guint position)
+{
+    return &journal->records[(journal->first + position) % JOURNAL_CAPACITY];
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+/* Most edits kept, after which the oldest are forgotten */
+#define JOURNAL_CAPACITY 4096
+
+/* Longest pause, in microseconds, between changes merged into one edit */
+#define JOURNAL_MERGE_INTERVAL 500000
+
+typedef struct {
+    Patch *patch;
+    guchar parameter;
+    guchar old_value;
+    guchar new_value;
+    gboolean grouped;
+} JournalRecord;
+
+typedef struct {
+    JournalRecord *records;
+    guint first;
+    guint count;
+    guint done;
+    gint64 last_time;
+    gboolean mergeable;
+    gboolean grouping;
+    guint group_size;
+} Journal;
+
+Journal *journal_new(void);
+void journal_free(Journal *);
+void journal_record(Journal *, Patch *, gint, guchar, guchar);
+void journal_begin_group(Journal *);
+void journal_end_group(Journal *);
+gint journal_undo(Journal *, const JournalRecord **);
+gint journal_redo(Journal *, const JournalRecord **);
+void journal_forget(Journal *, Patch *);
+
+#endif /* !JOURNAL_H */
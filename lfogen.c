@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <math.h>
+
+#include <glib.h>
+
+#include "envgen.h"
+#include "lfogen.h"
+
+/* Offsets of the LFO parameters from PARAMETER_LFOn_FREQUENCY */
+#define LFO_FREQUENCY 0
+#define LFO_RESET 1
+#define LFO_HUMAN 2
+#define LFO_WAVE 3
+#define LFO_INITIAL_LEVEL 4
+#define LFO_DELAY 5
+#define LFO_FINAL_LEVEL 6
+
+/* Bits of the phase below the wave table index */
+#define LFO_TABLE_SHIFT 24
+
+/*
+ * Frequencies in Hz for the frequency parameters 0 to 63, doubling every
+ * 8 steps from 0.1Hz.
+ */
+static const gfloat frequencies[64] = {
+    0.1000f, 0.1091f, 0.1189f, 0.1297f, 0.1414f, 0.1542f, 0.1682f, 0.1834f,
+    0.2000f, 0.2181f, 0.2378f, 0.2594f, 0.2828f, 0.3084f, 0.3364f, 0.3668f,
+    0.4000f, 0.4362f, 0.4757f, 0.5187f, 0.5657f, 0.6169f, 0.6727f, 0.7336f,
+    0.8000f, 0.8724f, 0.9514f, 1.0375f, 1.1314f, 1.2338f, 1.3454f, 1.4672f,
+    1.6000f, 1.7448f, 1.9027f, 2.0749f, 2.2627f, 2.4675f, 2.6909f, 2.9344f,
+    3.2000f, 3.4896f, 3.8055f, 4.1499f, 4.5255f, 4.9351f, 5.3817f, 5.8688f,
+    6.4000f, 6.9792f, 7.6109f, 8.2998f, 9.0510f, 9.8701f, 10.7635f, 11.7377f,
+    12.8000f, 13.9585f, 15.2219f, 16.5995f, 18.1019f, 19.7403f, 21.5269f, 23.4753f
+};
+
+/* The triangle, saw and square waves, filled in on first use */
+static gfloat waves[LFOGEN_WAVE_NOISE][LFOGEN_TABLE_SIZE];
+
+static void initialise_waves(void);
+static guint32 next_random(guint32 *);
+
+/**
+   \brief Returns the frequency of an LFO.
+
+   \param frequency - the frequency parameter, from 0 to 63.
+   \return the frequency in Hz.
+ */
+gfloat
+lfogen_frequency(gint frequency)
+{
+    return frequencies[CLAMP(frequency, 0, 63)];
+}
+
+/**
+   \brief Converts the parameters of an LFO into a phase increment and
+   levels for stepping at a control rate.
+
+   \param params - the increment and levels to fill in.
+   \param values - the parameters of the LFO, starting with the frequency.
+   \param rate - the number of steps a second.
+ */
+void
+lfogen_params(LfoParams *params, const guchar *values, gfloat rate)
+{
+    gfloat delay;
+
+    initialise_waves();
+
+    params->increment = (guint32) (lfogen_frequency(values[LFO_FREQUENCY]) / rate * 4294967296.0);
+    params->wave = values[LFO_WAVE] & 3;
+    params->reset = values[LFO_RESET] ? TRUE : FALSE;
+    params->human = values[LFO_HUMAN] ? TRUE : FALSE;
+    params->initial = MIN(values[LFO_INITIAL_LEVEL], 63) / 63.0f;
+    params->final = MIN(values[LFO_FINAL_LEVEL], 63) / 63.0f;
+
+    /* the level moves from the initial to the final level over the delay */
+    delay = MAX(envgen_time(values[LFO_DELAY]), 0.001f);
+    params->step = (params->final - params->initial) / (delay * rate);
+}
+
+/**
+   \brief Seeds the noise of an LFO and gives it a random phase, so that
+   LFOs that are not reset drift apart.
+
+   \param gen - the LFO.
+   \param seed - the seed, which must not be zero.
+ */
+void
+lfogen_init(LfoGen *gen, guint32 seed)
+{
+    gen->seed = seed;
+    gen->phase = next_random(&gen->seed);
+    gen->noise = 0;
+}
+
+/**
+   \brief Starts an LFO for a note, at the initial level and from the start
+   of its cycle if it is reset.
+
+   \param gen - the LFO.
+   \param params - the increment and levels.
+ */
+void
+lfogen_start(LfoGen *gen, const LfoParams *params)
+{
+    gen->params = *params;
+    gen->increment = params->increment;
+    gen->level = params->initial;
+
+    if (params->reset) {
+        gen->phase = 0;
+    }
+}
+
+/**
+   \brief Advances an LFO by a step.
+
+   \param gen - the LFO.
+   \param mod - the modulation of the level, added to the level.
+   \return the output of the LFO, from -1 to 1.
+ */
+gfloat
+lfogen_step(LfoGen *gen, gfloat mod)
+{
+    const LfoParams *params = &gen->params;
+    guint32 phase;
+    gfloat value, depth;
+
+    phase = gen->phase + gen->increment;
+
+    /* a new cycle picks a new noise value and, if humanised, varies the rate by up to 10% */
+    if (phase < gen->phase) {
+        gen->noise = (gint32) next_random(&gen->seed) / 2147483648.0f;
+        if (params->human) {
+            gen->increment = params->increment + (gint32) (params->increment / 10.0f * ((gint32) next_random(&gen->seed) / 2147483648.0f));
+        }
+    }
+    gen->phase = phase;
+
+    if (fabsf(params->final - gen->level) <= fabsf(params->step)) {
+        gen->level = params->final;
+    } else {
+        gen->level += params->step;
+    }
+
+    if (params->wave == LFOGEN_WAVE_NOISE) {
+        value = gen->noise;
+    } else {
+        value = waves[params->wave][phase >> LFO_TABLE_SHIFT];
+    }
+
+    depth = CLAMP(gen->level + mod, 0.0f, 1.0f);
+
+    return value * depth;
+}
+
+/**
+   \brief Advances an LFO by a number of steps with no modulation.
+
+   \param gen - the LFO.
+   \param values - the outputs, one for each step.
+   \param count - the number of steps.
+ */
+void
+lfogen_render(LfoGen *gen, gfloat *values, gint count)
+{
+    gint i;
+
+    for (i = 0; i < count; ++i) {
+        values[i] = lfogen_step(gen, 0);
+    }
+}
+
+static void
+initialise_waves(void)
+{
+    static gsize initialised = 0;
+    gfloat phase;
+    gint i;
+
+    if (g_once_init_enter(&initialised)) {
+        for (i = 0; i < LFOGEN_TABLE_SIZE; ++i) {
+            phase = (gfloat) i / LFOGEN_TABLE_SIZE;
+            waves[LFOGEN_WAVE_TRIANGLE][i] = 1.0f - 4.0f * fabsf(phase - 0.5f);
+            waves[LFOGEN_WAVE_SAW][i] = 2.0f * phase - 1.0f;
+            waves[LFOGEN_WAVE_SQUARE][i] = phase < 0.5f ? 1.0f : -1.0f;
+        }
+        g_once_init_leave(&initialised, 1);
+    }
+}
+
+static guint32
+next_random(guint32 *seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+
+    return *seed;
+}
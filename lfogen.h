@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef LFOGEN_H
+#define LFOGEN_H
+
+/* Number of LFO parameters from PARAMETER_LFOn_FREQUENCY */
+#define LFOGEN_PARAMETER_COUNT 8
+
+/* Number of entries in each wave table, indexed by the top of the phase */
+#define LFOGEN_TABLE_SIZE 256
+
+typedef enum {
+    LFOGEN_WAVE_TRIANGLE,
+    LFOGEN_WAVE_SAW,
+    LFOGEN_WAVE_SQUARE,
+    LFOGEN_WAVE_NOISE
+} LfoGenWave;
+
+typedef struct {
+    guint32 increment;
+    LfoGenWave wave;
+    gboolean reset;
+    gboolean human;
+    gfloat initial;
+    gfloat final;
+    gfloat step;
+} LfoParams;
+
+typedef struct {
+    LfoParams params;
+    guint32 phase;
+    guint32 increment;
+    guint32 seed;
+    gfloat level;
+    gfloat noise;
+} LfoGen;
+
+gfloat lfogen_frequency(gint);
+void lfogen_params(LfoParams *, const guchar *, gfloat);
+
+void lfogen_init(LfoGen *, guint32);
+void lfogen_start(LfoGen *, const LfoParams *);
+gfloat lfogen_step(LfoGen *, gfloat);
+void lfogen_render(LfoGen *, gfloat *, gint);
+
+#endif /* !LFOGEN_H */
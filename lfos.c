@@ -14,153 +14,31 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <math.h>
 #include <gtk/gtk.h>
 
 #include "main.h"
+#include "parameters.h"
+#include "journal.h"
 #include "dialog.h"
+#include "envgen.h"
+#include "lfogen.h"
 #include "lfos.h"
 
-static ScaleParams lfo1_frequency_params = {
-    .parameter = PARAMETER_LFO1_FREQUENCY,
-    .multiplier = 2
-};
-
-static ComboBoxEntry lfo1_waves[] = {
-    { "Triangle", PARAMETER_LFO1_WAVE, 0x00 },
-    { "Sawtooth", PARAMETER_LFO1_WAVE, 0x20 },
-    { "Square",   PARAMETER_LFO1_WAVE, 0x40 },
-    { "Noise",    PARAMETER_LFO1_WAVE, 0x60 }
-};
-
-static ScaleParams lfo1_initial_level_params = {
-    .parameter = PARAMETER_LFO1_INITIAL_LEVEL,
-    .multiplier = 2
-};
-
-static ScaleParams lfo1_delay_params = {
-    .parameter = PARAMETER_LFO1_DELAY,
-    .multiplier = 2
-};
-
-static ScaleParams lfo1_final_level_params = {
-    .parameter = PARAMETER_LFO1_FINAL_LEVEL,
-    .multiplier = 2
-};
-
-static ComboBoxEntry lfo1_mod_srcs[] = {
-    { "LFO 1",               PARAMETER_LFO1_MOD_SRC, 0x00 },
-    { "LFO 2",               PARAMETER_LFO1_MOD_SRC, 0x08 },
-    { "LFO 3",               PARAMETER_LFO1_MOD_SRC, 0x10 },
-    { "Envelope 1",          PARAMETER_LFO1_MOD_SRC, 0x18 },
-    { "Envelope 2",          PARAMETER_LFO1_MOD_SRC, 0x20 },
-    { "Envelope 3",          PARAMETER_LFO1_MOD_SRC, 0x28 },
-    { "Envelope 4",          PARAMETER_LFO1_MOD_SRC, 0x30 },
-    { "Velocity",            PARAMETER_LFO1_MOD_SRC, 0x38 },
-    { "Velocity X",          PARAMETER_LFO1_MOD_SRC, 0x40 },
-    { "Keyboard",            PARAMETER_LFO1_MOD_SRC, 0x48 },
-    { "Keyboard 2",          PARAMETER_LFO1_MOD_SRC, 0x50 },
-    { "Modulation Wheel",    PARAMETER_LFO1_MOD_SRC, 0x58 },
-    { "Foot Pedal",          PARAMETER_LFO1_MOD_SRC, 0x60 },
-    { "External Controller", PARAMETER_LFO1_MOD_SRC, 0x68 },
-    { "Pressure",            PARAMETER_LFO1_MOD_SRC, 0x70 },
-    { "Off",                 PARAMETER_LFO1_MOD_SRC, 0x78 }
-};
-
-static ScaleParams lfo2_frequency_params = {
-    .parameter = PARAMETER_LFO2_FREQUENCY,
-    .multiplier = 2
-};
-
-static ComboBoxEntry lfo2_waves[] = {
-    { "Triangle", PARAMETER_LFO2_WAVE, 0x00 },
-    { "Sawtooth", PARAMETER_LFO2_WAVE, 0x20 },
-    { "Square",   PARAMETER_LFO2_WAVE, 0x40 },
-    { "Noise",    PARAMETER_LFO2_WAVE, 0x60 }
-};
-
-static ScaleParams lfo2_initial_level_params = {
-    .parameter = PARAMETER_LFO2_INITIAL_LEVEL,
-    .multiplier = 2
-};
-
-static ScaleParams lfo2_delay_params = {
-    .parameter = PARAMETER_LFO2_DELAY,
-    .multiplier = 2
-};
-
-static ScaleParams lfo2_final_level_params = {
-    .parameter = PARAMETER_LFO2_FINAL_LEVEL,
-    .multiplier = 2
-};
-
-static ComboBoxEntry lfo2_mod_srcs[] = {
-    { "LFO 1",               PARAMETER_LFO2_MOD_SRC, 0x00 },
-    { "LFO 2",               PARAMETER_LFO2_MOD_SRC, 0x08 },
-    { "LFO 3",               PARAMETER_LFO2_MOD_SRC, 0x10 },
-    { "Envelope 1",          PARAMETER_LFO2_MOD_SRC, 0x18 },
-    { "Envelope 2",          PARAMETER_LFO2_MOD_SRC, 0x20 },
-    { "Envelope 3",          PARAMETER_LFO2_MOD_SRC, 0x28 },
-    { "Envelope 4",          PARAMETER_LFO2_MOD_SRC, 0x30 },
-    { "Velocity",            PARAMETER_LFO2_MOD_SRC, 0x38 },
-    { "Velocity X",          PARAMETER_LFO2_MOD_SRC, 0x40 },
-    { "Keyboard",            PARAMETER_LFO2_MOD_SRC, 0x48 },
-    { "Keyboard 2",          PARAMETER_LFO2_MOD_SRC, 0x50 },
-    { "Modulation Wheel",    PARAMETER_LFO2_MOD_SRC, 0x58 },
-    { "Foot Pedal",          PARAMETER_LFO2_MOD_SRC, 0x60 },
-    { "External Controller", PARAMETER_LFO2_MOD_SRC, 0x68 },
-    { "Pressure",            PARAMETER_LFO2_MOD_SRC, 0x70 },
-    { "Off",                 PARAMETER_LFO2_MOD_SRC, 0x78 }
-};
-
-static ScaleParams lfo3_frequency_params = {
-    .parameter = PARAMETER_LFO3_FREQUENCY,
-    .multiplier = 2
-};
-
-static ComboBoxEntry lfo3_waves[] = {
-    { "Triangle", PARAMETER_LFO3_WAVE, 0x00 },
-    { "Sawtooth", PARAMETER_LFO3_WAVE, 0x20 },
-    { "Square",   PARAMETER_LFO3_WAVE, 0x40 },
-    { "Noise",    PARAMETER_LFO3_WAVE, 0x60 }
-};
-
-static ScaleParams lfo3_initial_level_params = {
-    .parameter = PARAMETER_LFO3_INITIAL_LEVEL,
-    .multiplier = 2
-};
-
-static ScaleParams lfo3_delay_params = {
-    .parameter = PARAMETER_LFO3_DELAY,
-    .multiplier = 2
-};
-
-static ScaleParams lfo3_final_level_params = {
-    .parameter = PARAMETER_LFO3_FINAL_LEVEL,
-    .multiplier = 2
-};
-
-static ComboBoxEntry lfo3_mod_srcs[] = {
-    { "LFO 1",               PARAMETER_LFO3_MOD_SRC, 0x00 },
-    { "LFO 2",               PARAMETER_LFO3_MOD_SRC, 0x08 },
-    { "LFO 3",               PARAMETER_LFO3_MOD_SRC, 0x10 },
-    { "Envelope 1",          PARAMETER_LFO3_MOD_SRC, 0x18 },
-    { "Envelope 2",          PARAMETER_LFO3_MOD_SRC, 0x20 },
-    { "Envelope 3",          PARAMETER_LFO3_MOD_SRC, 0x28 },
-    { "Envelope 4",          PARAMETER_LFO3_MOD_SRC, 0x30 },
-    { "Velocity",            PARAMETER_LFO3_MOD_SRC, 0x38 },
-    { "Velocity X",          PARAMETER_LFO3_MOD_SRC, 0x40 },
-    { "Keyboard",            PARAMETER_LFO3_MOD_SRC, 0x48 },
-    { "Keyboard 2",          PARAMETER_LFO3_MOD_SRC, 0x50 },
-    { "Modulation Wheel",    PARAMETER_LFO3_MOD_SRC, 0x58 },
-    { "Foot Pedal",          PARAMETER_LFO3_MOD_SRC, 0x60 },
-    { "External Controller", PARAMETER_LFO3_MOD_SRC, 0x68 },
-    { "Pressure",            PARAMETER_LFO3_MOD_SRC, 0x70 },
-    { "Off",                 PARAMETER_LFO3_MOD_SRC, 0x78 }
-};
+/* Seed for the noise and humanised rate of the previews */
+#define LFOS_PREVIEW_SEED 0x2545f491U
 
 static GtkWidget *create_lfo1(Lfo *);
 static GtkWidget *create_lfo2(Lfo *);
 static GtkWidget *create_lfo3(Lfo *);
+static void create_preview(Lfo *, GtkGrid *);
+static gboolean lfo_event_callback(GtkWidget *, cairo_t *, gpointer);
+static void lfo_size_callback(GtkWidget *, GdkRectangle *, gpointer);
+static void lfo_wave_callback(GtkWidget *, gpointer);
+static void lfo_level_callback(GtkWidget *, gpointer);
+static void lfo_draw(Lfo *, cairo_t *);
+static void lfo_samples(Lfo *, gint);
+static cairo_surface_t *lfo_background(Lfo *, gint, gint);
 
 LfosDialog *
 new_lfos_dialog(GtkWindow *parent)
@@ -169,10 +47,14 @@ new_lfos_dialog(GtkWindow *parent)
     GtkGrid *grid;
     GtkWidget *button_box, *button;
 
-    widgets = g_new(LfosDialog, 1);
+    widgets = g_new0(LfosDialog, 1);
 
     widgets->dialog = create_window(parent, "LFOs", FALSE);
 
+    widgets->lfo1.dialog = widgets->dialog;
+    widgets->lfo2.dialog = widgets->dialog;
+    widgets->lfo3.dialog = widgets->dialog;
+
     grid = create_grid(GTK_CONTAINER(widgets->dialog));
 
     gtk_grid_attach(grid, create_lfo1(&widgets->lfo1), 0, 0, 1, 1);
@@ -210,13 +92,13 @@ set_lfos_parameters(LfosDialog *widgets, Patch *patch)
         patch->parameters[PARAMETER_LFO1_FINAL_LEVEL],
         patch->parameters[PARAMETER_LFO1_MOD_SRC]);
 
-    gtk_range_set_value(GTK_RANGE(widgets->lfo1.frequency), patch->parameters[PARAMETER_LFO1_FREQUENCY]);
+    gtk_range_set_value(GTK_RANGE(widgets->lfo1.frequency), parameters_decode(PARAMETER_LFO1_FREQUENCY, patch->parameters[PARAMETER_LFO1_FREQUENCY]));
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->lfo1.reset), patch->parameters[PARAMETER_LFO1_RESET] ? TRUE : FALSE);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->lfo1.human), patch->parameters[PARAMETER_LFO1_HUMAN] ? TRUE : FALSE);
     gtk_combo_box_set_active(GTK_COMBO_BOX(widgets->lfo1.wave), patch->parameters[PARAMETER_LFO1_WAVE]);
-    gtk_range_set_value(GTK_RANGE(widgets->lfo1.initial_level), patch->parameters[PARAMETER_LFO1_INITIAL_LEVEL]);
-    gtk_range_set_value(GTK_RANGE(widgets->lfo1.delay), patch->parameters[PARAMETER_LFO1_DELAY]);
-    gtk_range_set_value(GTK_RANGE(widgets->lfo1.final_level), patch->parameters[PARAMETER_LFO1_FINAL_LEVEL]);
+    gtk_range_set_value(GTK_RANGE(widgets->lfo1.initial_level), parameters_decode(PARAMETER_LFO1_INITIAL_LEVEL, patch->parameters[PARAMETER_LFO1_INITIAL_LEVEL]));
+    gtk_range_set_value(GTK_RANGE(widgets->lfo1.delay), parameters_decode(PARAMETER_LFO1_DELAY, patch->parameters[PARAMETER_LFO1_DELAY]));
+    gtk_range_set_value(GTK_RANGE(widgets->lfo1.final_level), parameters_decode(PARAMETER_LFO1_FINAL_LEVEL, patch->parameters[PARAMETER_LFO1_FINAL_LEVEL]));
     gtk_combo_box_set_active(GTK_COMBO_BOX(widgets->lfo1.mod_src), patch->parameters[PARAMETER_LFO1_MOD_SRC]);
 
     printf("Setting LFO2 parameters: frequency %d, reset %d, human %d, wave %d, initial level %d, delay %d, final level %d, mod src %d\n",
@@ -229,13 +111,13 @@ set_lfos_parameters(LfosDialog *widgets, Patch *patch)
         patch->parameters[PARAMETER_LFO2_FINAL_LEVEL],
         patch->parameters[PARAMETER_LFO2_MOD_SRC]);
 
-    gtk_range_set_value(GTK_RANGE(widgets->lfo2.frequency), patch->parameters[PARAMETER_LFO2_FREQUENCY]);
+    gtk_range_set_value(GTK_RANGE(widgets->lfo2.frequency), parameters_decode(PARAMETER_LFO2_FREQUENCY, patch->parameters[PARAMETER_LFO2_FREQUENCY]));
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->lfo2.reset), patch->parameters[PARAMETER_LFO2_RESET] ? TRUE : FALSE);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->lfo2.human), patch->parameters[PARAMETER_LFO2_HUMAN] ? TRUE : FALSE);
     gtk_combo_box_set_active(GTK_COMBO_BOX(widgets->lfo2.wave), patch->parameters[PARAMETER_LFO2_WAVE]);
-    gtk_range_set_value(GTK_RANGE(widgets->lfo2.initial_level), patch->parameters[PARAMETER_LFO2_INITIAL_LEVEL]);
-    gtk_range_set_value(GTK_RANGE(widgets->lfo2.delay), patch->parameters[PARAMETER_LFO2_DELAY]);
-    gtk_range_set_value(GTK_RANGE(widgets->lfo2.final_level), patch->parameters[PARAMETER_LFO2_FINAL_LEVEL]);
+    gtk_range_set_value(GTK_RANGE(widgets->lfo2.initial_level), parameters_decode(PARAMETER_LFO2_INITIAL_LEVEL, patch->parameters[PARAMETER_LFO2_INITIAL_LEVEL]));
+    gtk_range_set_value(GTK_RANGE(widgets->lfo2.delay), parameters_decode(PARAMETER_LFO2_DELAY, patch->parameters[PARAMETER_LFO2_DELAY]));
+    gtk_range_set_value(GTK_RANGE(widgets->lfo2.final_level), parameters_decode(PARAMETER_LFO2_FINAL_LEVEL, patch->parameters[PARAMETER_LFO2_FINAL_LEVEL]));
     gtk_combo_box_set_active(GTK_COMBO_BOX(widgets->lfo2.mod_src), patch->parameters[PARAMETER_LFO2_MOD_SRC]);
 
     printf("Setting LFO3 parameters: frequency %d, reset %d, human %d, wave %d, initial level %d, delay %d, final level %d, mod src %d\n",
@@ -248,13 +130,13 @@ set_lfos_parameters(LfosDialog *widgets, Patch *patch)
         patch->parameters[PARAMETER_LFO3_FINAL_LEVEL],
         patch->parameters[PARAMETER_LFO3_MOD_SRC]);
 
-    gtk_range_set_value(GTK_RANGE(widgets->lfo3.frequency), patch->parameters[PARAMETER_LFO3_FREQUENCY]);
+    gtk_range_set_value(GTK_RANGE(widgets->lfo3.frequency), parameters_decode(PARAMETER_LFO3_FREQUENCY, patch->parameters[PARAMETER_LFO3_FREQUENCY]));
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->lfo3.reset), patch->parameters[PARAMETER_LFO3_RESET] ? TRUE : FALSE);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->lfo3.human), patch->parameters[PARAMETER_LFO3_HUMAN] ? TRUE : FALSE);
     gtk_combo_box_set_active(GTK_COMBO_BOX(widgets->lfo3.wave), patch->parameters[PARAMETER_LFO3_WAVE]);
-    gtk_range_set_value(GTK_RANGE(widgets->lfo3.initial_level), patch->parameters[PARAMETER_LFO3_INITIAL_LEVEL]);
-    gtk_range_set_value(GTK_RANGE(widgets->lfo3.delay), patch->parameters[PARAMETER_LFO3_DELAY]);
-    gtk_range_set_value(GTK_RANGE(widgets->lfo3.final_level), patch->parameters[PARAMETER_LFO3_FINAL_LEVEL]);
+    gtk_range_set_value(GTK_RANGE(widgets->lfo3.initial_level), parameters_decode(PARAMETER_LFO3_INITIAL_LEVEL, patch->parameters[PARAMETER_LFO3_INITIAL_LEVEL]));
+    gtk_range_set_value(GTK_RANGE(widgets->lfo3.delay), parameters_decode(PARAMETER_LFO3_DELAY, patch->parameters[PARAMETER_LFO3_DELAY]));
+    gtk_range_set_value(GTK_RANGE(widgets->lfo3.final_level), parameters_decode(PARAMETER_LFO3_FINAL_LEVEL, patch->parameters[PARAMETER_LFO3_FINAL_LEVEL]));
     gtk_combo_box_set_active(GTK_COMBO_BOX(widgets->lfo3.mod_src), patch->parameters[PARAMETER_LFO3_MOD_SRC]);
 }
 
@@ -299,37 +181,45 @@ create_lfo1(Lfo *lfo)
 
     grid = create_grid(GTK_CONTAINER(frame));
 
+    create_preview(lfo, grid);
+
     label = gtk_label_new("Frequency:");
-    lfo->frequency = create_hscale_with_params(0, 63, &lfo1_frequency_params);
-    create_grid_row(grid, 0, GTK_LABEL(label), GTK_WIDGET(lfo->frequency));
+    lfo->frequency = create_hscale(PARAMETER_LFO1_FREQUENCY);
+    g_signal_connect(G_OBJECT(lfo->frequency), "value-changed", G_CALLBACK(lfo_wave_callback), lfo);
+    create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(lfo->frequency));
 
     label = gtk_label_new("Reset:");
     lfo->reset = create_check_button(PARAMETER_LFO1_RESET);
-    create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(lfo->reset));
+    create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(lfo->reset));
 
     label = gtk_label_new("Human:");
     lfo->human = create_check_button(PARAMETER_LFO1_HUMAN);
-    create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(lfo->human));
+    g_signal_connect(G_OBJECT(lfo->human), "toggled", G_CALLBACK(lfo_wave_callback), lfo);
+    create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(lfo->human));
 
     label = gtk_label_new("Wave:");
-    lfo->wave = create_combo_box_with_entries(lfo1_waves, G_N_ELEMENTS(lfo1_waves));
-    create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(lfo->wave));
+    lfo->wave = create_combo_box(PARAMETER_LFO1_WAVE);
+    g_signal_connect(G_OBJECT(lfo->wave), "changed", G_CALLBACK(lfo_wave_callback), lfo);
+    create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(lfo->wave));
 
     label = gtk_label_new("Initial Level:");
-    lfo->initial_level = create_hscale_with_params(0, 63, &lfo1_initial_level_params);
-    create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(lfo->initial_level));
+    lfo->initial_level = create_hscale(PARAMETER_LFO1_INITIAL_LEVEL);
+    g_signal_connect(G_OBJECT(lfo->initial_level), "value-changed", G_CALLBACK(lfo_level_callback), lfo);
+    create_grid_row(grid, 5, GTK_LABEL(label), GTK_WIDGET(lfo->initial_level));
 
     label = gtk_label_new("Delay:");
-    lfo->delay = create_hscale_with_params(0, 63, &lfo1_delay_params);
-    create_grid_row(grid, 5, GTK_LABEL(label), GTK_WIDGET(lfo->delay));
+    lfo->delay = create_hscale(PARAMETER_LFO1_DELAY);
+    g_signal_connect(G_OBJECT(lfo->delay), "value-changed", G_CALLBACK(lfo_level_callback), lfo);
+    create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(lfo->delay));
 
     label = gtk_label_new("Final Level:");
-    lfo->final_level = create_hscale_with_params(0, 63, &lfo1_final_level_params);
-    create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(lfo->final_level));
+    lfo->final_level = create_hscale(PARAMETER_LFO1_FINAL_LEVEL);
+    g_signal_connect(G_OBJECT(lfo->final_level), "value-changed", G_CALLBACK(lfo_level_callback), lfo);
+    create_grid_row(grid, 7, GTK_LABEL(label), GTK_WIDGET(lfo->final_level));
 
     label = gtk_label_new("Mod:");
-    lfo->mod_src = create_combo_box_with_entries(lfo1_mod_srcs, G_N_ELEMENTS(lfo1_mod_srcs));
-    create_grid_row(grid, 7, GTK_LABEL(label), GTK_WIDGET(lfo->mod_src));
+    lfo->mod_src = create_combo_box(PARAMETER_LFO1_MOD_SRC);
+    create_grid_row(grid, 8, GTK_LABEL(label), GTK_WIDGET(lfo->mod_src));
 
     return frame;
 }
@@ -344,37 +234,45 @@ create_lfo2(Lfo *lfo)
 
     grid = create_grid(GTK_CONTAINER(frame));
 
+    create_preview(lfo, grid);
+
     label = gtk_label_new("Frequency:");
-    lfo->frequency = create_hscale_with_params(0, 63, &lfo2_frequency_params);
-    create_grid_row(grid, 0, GTK_LABEL(label), GTK_WIDGET(lfo->frequency));
+    lfo->frequency = create_hscale(PARAMETER_LFO2_FREQUENCY);
+    g_signal_connect(G_OBJECT(lfo->frequency), "value-changed", G_CALLBACK(lfo_wave_callback), lfo);
+    create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(lfo->frequency));
 
     label = gtk_label_new("Reset:");
     lfo->reset = create_check_button(PARAMETER_LFO2_RESET);
-    create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(lfo->reset));
+    create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(lfo->reset));
 
     label = gtk_label_new("Human:");
     lfo->human = create_check_button(PARAMETER_LFO2_HUMAN);
-    create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(lfo->human));
+    g_signal_connect(G_OBJECT(lfo->human), "toggled", G_CALLBACK(lfo_wave_callback), lfo);
+    create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(lfo->human));
 
     label = gtk_label_new("Wave:");
-    lfo->wave = create_combo_box_with_entries(lfo2_waves, G_N_ELEMENTS(lfo2_waves));
-    create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(lfo->wave));
+    lfo->wave = create_combo_box(PARAMETER_LFO2_WAVE);
+    g_signal_connect(G_OBJECT(lfo->wave), "changed", G_CALLBACK(lfo_wave_callback), lfo);
+    create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(lfo->wave));
 
     label = gtk_label_new("Initial Level:");
-    lfo->initial_level = create_hscale_with_params(0, 63, &lfo2_initial_level_params);
-    create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(lfo->initial_level));
+    lfo->initial_level = create_hscale(PARAMETER_LFO2_INITIAL_LEVEL);
+    g_signal_connect(G_OBJECT(lfo->initial_level), "value-changed", G_CALLBACK(lfo_level_callback), lfo);
+    create_grid_row(grid, 5, GTK_LABEL(label), GTK_WIDGET(lfo->initial_level));
 
     label = gtk_label_new("Delay:");
-    lfo->delay = create_hscale_with_params(0, 63, &lfo2_delay_params);
-    create_grid_row(grid, 5, GTK_LABEL(label), GTK_WIDGET(lfo->delay));
+    lfo->delay = create_hscale(PARAMETER_LFO2_DELAY);
+    g_signal_connect(G_OBJECT(lfo->delay), "value-changed", G_CALLBACK(lfo_level_callback), lfo);
+    create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(lfo->delay));
 
     label = gtk_label_new("Final Level:");
-    lfo->final_level = create_hscale_with_params(0, 63, &lfo2_final_level_params);
-    create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(lfo->final_level));
+    lfo->final_level = create_hscale(PARAMETER_LFO2_FINAL_LEVEL);
+    g_signal_connect(G_OBJECT(lfo->final_level), "value-changed", G_CALLBACK(lfo_level_callback), lfo);
+    create_grid_row(grid, 7, GTK_LABEL(label), GTK_WIDGET(lfo->final_level));
 
     label = gtk_label_new("Mod:");
-    lfo->mod_src = create_combo_box_with_entries(lfo2_mod_srcs, G_N_ELEMENTS(lfo2_mod_srcs));
-    create_grid_row(grid, 7, GTK_LABEL(label), GTK_WIDGET(lfo->mod_src));
+    lfo->mod_src = create_combo_box(PARAMETER_LFO2_MOD_SRC);
+    create_grid_row(grid, 8, GTK_LABEL(label), GTK_WIDGET(lfo->mod_src));
 
     return frame;
 }
@@ -389,37 +287,284 @@ create_lfo3(Lfo *lfo)
 
     grid = create_grid(GTK_CONTAINER(frame));
 
+    create_preview(lfo, grid);
+
     label = gtk_label_new("Frequency:");
-    lfo->frequency = create_hscale_with_params(0, 63, &lfo3_frequency_params);
-    create_grid_row(grid, 0, GTK_LABEL(label), GTK_WIDGET(lfo->frequency));
+    lfo->frequency = create_hscale(PARAMETER_LFO3_FREQUENCY);
+    g_signal_connect(G_OBJECT(lfo->frequency), "value-changed", G_CALLBACK(lfo_wave_callback), lfo);
+    create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(lfo->frequency));
 
     label = gtk_label_new("Reset:");
     lfo->reset = create_check_button(PARAMETER_LFO3_RESET);
-    create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(lfo->reset));
+    create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(lfo->reset));
 
     label = gtk_label_new("Human:");
     lfo->human = create_check_button(PARAMETER_LFO3_HUMAN);
-    create_grid_row(grid, 2, GTK_LABEL(label), GTK_WIDGET(lfo->human));
+    g_signal_connect(G_OBJECT(lfo->human), "toggled", G_CALLBACK(lfo_wave_callback), lfo);
+    create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(lfo->human));
 
     label = gtk_label_new("Wave:");
-    lfo->wave = create_combo_box_with_entries(lfo3_waves, G_N_ELEMENTS(lfo3_waves));
-    create_grid_row(grid, 3, GTK_LABEL(label), GTK_WIDGET(lfo->wave));
+    lfo->wave = create_combo_box(PARAMETER_LFO3_WAVE);
+    g_signal_connect(G_OBJECT(lfo->wave), "changed", G_CALLBACK(lfo_wave_callback), lfo);
+    create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(lfo->wave));
 
     label = gtk_label_new("Initial Level:");
-    lfo->initial_level = create_hscale_with_params(0, 63, &lfo3_initial_level_params);
-    create_grid_row(grid, 4, GTK_LABEL(label), GTK_WIDGET(lfo->initial_level));
+    lfo->initial_level = create_hscale(PARAMETER_LFO3_INITIAL_LEVEL);
+    g_signal_connect(G_OBJECT(lfo->initial_level), "value-changed", G_CALLBACK(lfo_level_callback), lfo);
+    create_grid_row(grid, 5, GTK_LABEL(label), GTK_WIDGET(lfo->initial_level));
 
     label = gtk_label_new("Delay:");
-    lfo->delay = create_hscale_with_params(0, 63, &lfo3_delay_params);
-    create_grid_row(grid, 5, GTK_LABEL(label), GTK_WIDGET(lfo->delay));
+    lfo->delay = create_hscale(PARAMETER_LFO3_DELAY);
+    g_signal_connect(G_OBJECT(lfo->delay), "value-changed", G_CALLBACK(lfo_level_callback), lfo);
+    create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(lfo->delay));
 
     label = gtk_label_new("Final Level:");
-    lfo->final_level = create_hscale_with_params(0, 63, &lfo3_final_level_params);
-    create_grid_row(grid, 6, GTK_LABEL(label), GTK_WIDGET(lfo->final_level));
+    lfo->final_level = create_hscale(PARAMETER_LFO3_FINAL_LEVEL);
+    g_signal_connect(G_OBJECT(lfo->final_level), "value-changed", G_CALLBACK(lfo_level_callback), lfo);
+    create_grid_row(grid, 7, GTK_LABEL(label), GTK_WIDGET(lfo->final_level));
 
     label = gtk_label_new("Mod:");
-    lfo->mod_src = create_combo_box_with_entries(lfo3_mod_srcs, G_N_ELEMENTS(lfo3_mod_srcs));
-    create_grid_row(grid, 7, GTK_LABEL(label), GTK_WIDGET(lfo->mod_src));
+    lfo->mod_src = create_combo_box(PARAMETER_LFO3_MOD_SRC);
+    create_grid_row(grid, 8, GTK_LABEL(label), GTK_WIDGET(lfo->mod_src));
 
     return frame;
 }
+
+/*
+ * Adds a drawing area showing the LFO to the top row of its grid.
+ */
+static void
+create_preview(Lfo *lfo, GtkGrid *grid)
+{
+    GtkWidget *preview_frame;
+
+    preview_frame = gtk_frame_new(NULL);
+    gtk_frame_set_shadow_type(GTK_FRAME(preview_frame), GTK_SHADOW_IN);
+    gtk_grid_attach(grid, preview_frame, 0, 0, 2, 1);
+
+    lfo->preview = gtk_drawing_area_new();
+    gtk_widget_set_size_request(GTK_WIDGET(lfo->preview), 317, 127);
+    g_signal_connect(G_OBJECT(lfo->preview), "draw", G_CALLBACK(lfo_event_callback), lfo);
+    g_signal_connect(G_OBJECT(lfo->preview), "size-allocate", G_CALLBACK(lfo_size_callback), lfo);
+    gtk_container_add(GTK_CONTAINER(preview_frame), lfo->preview);
+}
+
+static gboolean
+lfo_event_callback(GtkWidget *widget, cairo_t *cairo, gpointer data)
+{
+    Lfo *lfo = (Lfo *) data;
+
+    lfo_draw(lfo, cairo);
+
+    return TRUE;
+}
+
+static void
+lfo_size_callback(GtkWidget *widget, GdkRectangle *allocation, gpointer data)
+{
+    Lfo *lfo = (Lfo *) data;
+
+    /* the cached background no longer fits, so rebuild it on the next draw */
+    if (lfo->background) {
+        cairo_surface_destroy(lfo->background);
+        lfo->background = NULL;
+    }
+}
+
+static void
+lfo_wave_callback(GtkWidget *widget, gpointer data)
+{
+    Lfo *lfo = (Lfo *) data;
+
+    lfo->waves_valid = FALSE;
+
+    if (gtk_widget_get_visible(GTK_WIDGET(lfo->dialog))) {
+        gtk_widget_queue_draw(lfo->preview);
+    }
+}
+
+static void
+lfo_level_callback(GtkWidget *widget, gpointer data)
+{
+    Lfo *lfo = (Lfo *) data;
+
+    lfo->levels_valid = FALSE;
+
+    if (gtk_widget_get_visible(GTK_WIDGET(lfo->dialog))) {
+        gtk_widget_queue_draw(lfo->preview);
+    }
+}
+
+/*
+ * Draws the output of the LFO from the start of a note, through the delay
+ * and a few cycles at the final level. The level is drawn dashed around
+ * the wave.
+ */
+static void
+lfo_draw(Lfo *widgets, cairo_t *cairo)
+{
+    GtkAllocation allocation;
+    gdouble middle, height, delay;
+    gint i;
+    double dashes[2];
+
+    gtk_widget_get_allocation(widgets->preview, &allocation);
+
+    if (allocation.width < 2) {
+        return;
+    }
+
+    lfo_samples(widgets, allocation.width);
+
+    middle = allocation.height / 2.0;
+    height = middle - 2;
+
+    dashes[0] = 2;
+    dashes[1] = 2;
+
+    /* draw background */
+
+    cairo_set_source_surface(cairo, lfo_background(widgets, allocation.width, allocation.height), 0, 0);
+    cairo_paint(cairo);
+
+    /* draw LFO */
+
+    cairo_set_source_rgb(cairo, 0, 0, 0);
+
+    cairo_set_line_width(cairo, 2);
+    cairo_set_line_cap(cairo, CAIRO_LINE_CAP_ROUND);
+    cairo_set_line_join(cairo, CAIRO_LINE_JOIN_ROUND);
+
+    cairo_move_to(cairo, 0, middle - widgets->waves[0] * widgets->levels[0] * height);
+    for (i = 1; i < widgets->sample_count; ++i) {
+        cairo_line_to(cairo, i, middle - widgets->waves[i] * widgets->levels[i] * height);
+    }
+    cairo_stroke(cairo);
+
+    /* draw dashed lines */
+
+    cairo_set_line_width(cairo, 1);
+    cairo_set_dash(cairo, dashes, 2, 0);
+    cairo_set_line_cap(cairo, CAIRO_LINE_CAP_BUTT);
+    cairo_set_line_join(cairo, CAIRO_LINE_JOIN_MITER);
+
+    cairo_move_to(cairo, 0, middle - widgets->levels[0] * height);
+    for (i = 1; i < widgets->sample_count; ++i) {
+        cairo_line_to(cairo, i, middle - widgets->levels[i] * height);
+    }
+    cairo_move_to(cairo, 0, middle + widgets->levels[0] * height);
+    for (i = 1; i < widgets->sample_count; ++i) {
+        cairo_line_to(cairo, i, middle + widgets->levels[i] * height);
+    }
+
+    delay = envgen_time(gtk_range_get_value(GTK_RANGE(widgets->delay)));
+    if (delay > 0) {
+        cairo_move_to(cairo, floor(allocation.width * delay / widgets->span) + 0.5, 0);
+        cairo_line_to(cairo, floor(allocation.width * delay / widgets->span) + 0.5, allocation.height);
+    }
+    cairo_stroke(cairo);
+}
+
+/*
+ * Brings the cached samples of the LFO up to date, one for each pixel
+ * across the drawing area. The wave at full level and the level are cached
+ * separately, so moving a level slider doesn't run the LFO again.
+ */
+static void
+lfo_samples(Lfo *widgets, gint count)
+{
+    guchar values[LFOGEN_PARAMETER_COUNT];
+    LfoParams params;
+    LfoGen gen;
+    gdouble span, delay, t;
+    gint i;
+
+    values[0] = gtk_range_get_value(GTK_RANGE(widgets->frequency));
+    values[1] = TRUE;
+    values[2] = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->human));
+    values[3] = MAX(gtk_combo_box_get_active(GTK_COMBO_BOX(widgets->wave)), 0);
+    values[4] = gtk_range_get_value(GTK_RANGE(widgets->initial_level));
+    values[5] = gtk_range_get_value(GTK_RANGE(widgets->delay));
+    values[6] = gtk_range_get_value(GTK_RANGE(widgets->final_level));
+    values[7] = 0;
+
+    /* the delay and then four cycles */
+    delay = envgen_time(values[5]);
+    span = delay + 4.0 / lfogen_frequency(values[0]);
+
+    if (count != widgets->sample_count) {
+        widgets->waves = g_renew(gfloat, widgets->waves, count);
+        widgets->levels = g_renew(gfloat, widgets->levels, count);
+        widgets->sample_count = count;
+        widgets->waves_valid = FALSE;
+        widgets->levels_valid = FALSE;
+    }
+
+    if (span != widgets->span) {
+        widgets->span = span;
+        widgets->waves_valid = FALSE;
+        widgets->levels_valid = FALSE;
+    }
+
+    if (!widgets->waves_valid) {
+        values[4] = 63;
+        values[6] = 63;
+        lfogen_params(&params, values, count / span);
+        lfogen_init(&gen, LFOS_PREVIEW_SEED);
+        lfogen_start(&gen, &params);
+        lfogen_render(&gen, widgets->waves, count);
+        values[4] = gtk_range_get_value(GTK_RANGE(widgets->initial_level));
+        values[6] = gtk_range_get_value(GTK_RANGE(widgets->final_level));
+        widgets->waves_valid = TRUE;
+    }
+
+    if (!widgets->levels_valid) {
+        for (i = 0; i < count; ++i) {
+            t = span * i / count;
+            if (t >= delay) {
+                widgets->levels[i] = values[6] / 63.0f;
+            } else {
+                widgets->levels[i] = (values[4] + (values[6] - values[4]) * t / delay) / 63.0f;
+            }
+        }
+        widgets->levels_valid = TRUE;
+    }
+}
+
+/*
+ * Returns the background and grid of an LFO graphic, which only needs to
+ * be drawn again when the drawing area changes size.
+ */
+static cairo_surface_t *
+lfo_background(Lfo *widgets, gint width, gint height)
+{
+    cairo_t *cairo;
+    gint i;
+
+    if (widgets->background) {
+        return widgets->background;
+    }
+
+    widgets->background = gdk_window_create_similar_surface(gtk_widget_get_window(widgets->preview), CAIRO_CONTENT_COLOR, width, height);
+
+    cairo = cairo_create(widgets->background);
+
+    cairo_set_source_rgb(cairo, 1, 1, 1);
+    cairo_paint(cairo);
+
+    cairo_set_source_rgb(cairo, 0.85, 0.85, 0.85);
+    cairo_set_line_width(cairo, 1);
+
+    for (i = 1; i < 4; ++i) {
+        cairo_move_to(cairo, 0, (height * i / 4) + 0.5);
+        cairo_line_to(cairo, width, (height * i / 4) + 0.5);
+        cairo_move_to(cairo, (width * i / 4) + 0.5, 0);
+        cairo_line_to(cairo, (width * i / 4) + 0.5, height);
+    }
+
+    cairo_stroke(cairo);
+
+    cairo_destroy(cairo);
+
+    return widgets->background;
+}
@@ -18,6 +18,15 @@
 #define LFOS_H
 
 typedef struct {
+    GtkWindow *dialog;
+    GtkWidget *preview;
+    cairo_surface_t *background;
+    gfloat *waves;
+    gfloat *levels;
+    gint sample_count;
+    gdouble span;
+    gboolean waves_valid;
+    gboolean levels_valid;
     GtkScale *frequency;
     GtkCheckButton *reset;
     GtkCheckButton *human;
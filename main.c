@@ -19,6 +19,9 @@
 #include <gtk/gtk.h>
 
 #include "main.h"
+#include "patch.h"
+#include "parameters.h"
+#include "journal.h"
 #include "midi.h"
 #include "dialog.h"
 #include "device.h"
@@ -29,11 +32,27 @@
 #include "amplifier.h"
 #include "modes.h"
 #include "xmlparser.h"
+#include "envgen.h"
+#include "lfogen.h"
+#include "modmatrix.h"
+#include "vcf.h"
+#include "synth.h"
+#include "batch.h"
+#include "fingerprint.h"
+#include "similar.h"
+#include "duplicates.h"
+#include "compare.h"
+#include "history.h"
+#include "preview.h"
+#include "similardialog.h"
+#include "collapsedialog.h"
+#include "validatedialog.h"
+#include "morphdialog.h"
+#include "variationsdialog.h"
+#include "historydialog.h"
 
 Patch *current_patch = NULL;
 
-enum { NAME_COL, TYPE_COL, DATA_COL, NCOLS };
-
 typedef struct {
     GtkWidget *window;
     GtkWidget *oscillators_menu_item;
@@ -42,8 +61,21 @@ typedef struct {
     GtkWidget *envelopes_menu_item;
     GtkWidget *amplifier_menu_item;
     GtkWidget *modes_menu_item;
+    GtkWidget *similar_menu_item;
+    GtkWidget *morph_menu_item;
+    GtkWidget *variations_menu_item;
+    GtkWidget *store_a_menu_item;
+    GtkWidget *store_b_menu_item;
+    GtkWidget *switch_menu_item;
+    GtkWidget *history_menu_item;
+    GtkWidget *undo_menu_item;
+    GtkWidget *redo_menu_item;
     GtkWidget *tree_view;
     Statusbar statusbar;
+    DuplicateIndex *duplicates;
+    Journal *journal;
+    Compare compare;
+    History *history;
     OscillatorsDialog *oscillators_dialog;
     LfosDialog *lfos_dialog;
     FilterDialog *filter_dialog;
@@ -52,6 +84,41 @@ typedef struct {
     ModesDialog *modes_dialog;
 } MainWidgets;
 
+typedef struct {
+    GPtrArray *filenames;
+    gfloat *vectors;
+    gboolean *indexed;
+} IndexBatch;
+
+static gchar *waves_filename = NULL;
+static gchar *render_filename = NULL;
+static gchar *render_directory = NULL;
+static gint render_threads = 0;
+static gint render_note = 60;
+static gchar *render_chord = NULL;
+static gint render_notes[SYNTH_VOICE_COUNT];
+static gint render_note_count = 0;
+static gint render_velocity = 100;
+static gdouble render_duration = 2.0;
+static gchar *preview_device = NULL;
+static gchar *index_filename = NULL;
+static gchar *similar_filename = NULL;
+
+static GOptionEntry options[] = {
+    { "waves", 'w', 0, G_OPTION_ARG_FILENAME, &waves_filename, "Render with the waves in a dump of the SQ-80 wave ROM", "FILE" },
+    { "render", 'r', 0, G_OPTION_ARG_FILENAME, &render_filename, "Render a patch to a WAV file without starting the editor", "FILE" },
+    { "render-dir", 'R', 0, G_OPTION_ARG_FILENAME, &render_directory, "Render patches and directories of patches to WAV files in a directory", "DIR" },
+    { "threads", 't', 0, G_OPTION_ARG_INT, &render_threads, "Number of threads to render or index with (default one per processor)", "THREADS" },
+    { "note", 'n', 0, G_OPTION_ARG_INT, &render_note, "Note number to render (default 60)", "NOTE" },
+    { "chord", 'c', 0, G_OPTION_ARG_STRING, &render_chord, "Note numbers to render together, separated by commas", "NOTES" },
+    { "velocity", 'v', 0, G_OPTION_ARG_INT, &render_velocity, "Velocity to render (default 100)", "VELOCITY" },
+    { "duration", 'd', 0, G_OPTION_ARG_DOUBLE, &render_duration, "Seconds before the note is released (default 2)", "SECONDS" },
+    { "index", 'i', 0, G_OPTION_ARG_FILENAME, &index_filename, "Index how patches and directories of patches sound, in a file", "FILE" },
+    { "similar", 's', 0, G_OPTION_ARG_FILENAME, &similar_filename, "List the patches in an index that sound most like a patch", "PATCH" },
+    { "preview", 'p', 0, G_OPTION_ARG_STRING, &preview_device, "Play the patch being edited through an ALSA device, such as default or null", "DEVICE" },
+    { NULL }
+};
+
 static GtkWidget *create_file_menu(MainWidgets *);
 static GtkWidget *create_edit_menu(MainWidgets *);
 static GtkWidget *create_tree_view(MainWidgets *);
@@ -64,19 +131,91 @@ static void show_envelopes_dialog_callback(GtkWidget *, gpointer);
 static void show_amplifier_dialog_callback(GtkWidget *, gpointer);
 static void show_modes_dialog_callback(GtkWidget *, gpointer);
 static void show_callback(GtkWidget *, gpointer);
+static void edit_menu_callback(GtkWidget *, gpointer);
+static void undo_callback(GtkWidget *, gpointer);
+static void redo_callback(GtkWidget *, gpointer);
 static void new_callback(GtkWidget *, gpointer);
 static void open_callback(GtkWidget *, gpointer);
 static void save_callback(GtkWidget *, gpointer);
+static void render_callback(GtkWidget *, gpointer);
+static void similar_callback(GtkWidget *, gpointer);
+static void collapse_callback(GtkWidget *, gpointer);
+static void validate_callback(GtkWidget *, gpointer);
+static void morph_callback(GtkWidget *, gpointer);
+static void variations_callback(GtkWidget *, gpointer);
+static void store_a_callback(GtkWidget *, gpointer);
+static void store_b_callback(GtkWidget *, gpointer);
+static void switch_callback(GtkWidget *, gpointer);
+static void history_callback(GtkWidget *, gpointer);
+static void preview_callback(GtkWidget *, gpointer);
 static void close_callback(GtkWidget *, gpointer);
 static void quit_callback(GtkWidget *, gpointer);
 static void destroy_callback(GtkWidget *, gpointer);
-static void insert_patch(GtkWidget *, Patch *);
+static DuplicateKind insert_patch(MainWidgets *, Patch *, Patch **);
+static void insert_patches(MainWidgets *, Patch **, gint);
+static gint compare_patch_names(gconstpointer, gconstpointer, gpointer);
+static void forget_patch(MainWidgets *, Patch *);
+static void select_patch(GtkWidget *, Patch *);
+static void set_dialogs_parameters(MainWidgets *, Patch *);
+static void apply_edits(MainWidgets *, const JournalRecord **, gint, gboolean);
+static History *get_history(MainWidgets *, const Patch *);
+static gboolean parse_notes(void);
+static int render_patch(const gchar *);
+static int render_patches(gchar **, gint);
+static int index_patches(gchar **, gint);
+static gboolean index_patch(gint, gpointer);
+static int find_similar(const gchar *);
 
 int
 main(int argc, char *argv[])
 {
     MainWidgets widgets;
     GtkWidget *dialog, *vbox, *menu_bar, *menu_item, *scrolled_window;
+    GOptionContext *context;
+    GError *error = NULL;
+
+    context = g_option_context_new("[PATCH...]");
+    g_option_context_add_main_entries(context, options, NULL);
+    g_option_context_add_group(context, gtk_get_option_group(FALSE));
+
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        return 1;
+    }
+
+    g_option_context_free(context);
+
+    if (!parse_notes()) {
+        g_printerr("Invalid notes to render\n");
+        return 1;
+    }
+
+    if (waves_filename && !synth_load_waves(waves_filename, &error)) {
+        g_printerr("Unable to load %s:\n%s\n", waves_filename, error->message);
+        g_error_free(error);
+        return 1;
+    }
+
+    if (render_filename) {
+        if (argc != 2) {
+            g_printerr("A single patch must be given to render\n");
+            return 1;
+        }
+        return render_patch(argv[1]);
+    }
+
+    if (render_directory) {
+        return render_patches(argv + 1, argc - 1);
+    }
+
+    if (similar_filename) {
+        return find_similar(similar_filename);
+    }
+
+    if (index_filename) {
+        return index_patches(argv + 1, argc - 1);
+    }
 
     midi_initialise();
 
@@ -92,10 +231,21 @@ main(int argc, char *argv[])
         gtk_widget_destroy(dialog);
     }
 
+    if (preview_device && !preview_start(preview_device, &error)) {
+        g_printerr("Unable to start the preview:\n%s\n", error->message);
+        g_clear_error(&error);
+    }
+
     widgets.window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(widgets.window), "SQ-80");
     gtk_window_set_default_size(GTK_WINDOW(widgets.window), 400, 400);
     gtk_container_set_border_width(GTK_CONTAINER(widgets.window), 0);
+
+    widgets.duplicates = duplicates_new();
+    widgets.journal = journal_new();
+    set_journal(widgets.journal);
+    compare_init(&widgets.compare);
+    widgets.history = NULL;
     g_signal_connect(G_OBJECT(widgets.window), "show", G_CALLBACK(show_callback), &widgets);
     g_signal_connect(G_OBJECT(widgets.window), "destroy", G_CALLBACK(destroy_callback), NULL);
 
@@ -136,6 +286,8 @@ main(int argc, char *argv[])
 
     gtk_main();
 
+    preview_stop();
+
     return 0;
 }
 
@@ -175,6 +327,10 @@ create_file_menu(MainWidgets *widgets)
     g_signal_connect(G_OBJECT(menu_item), "activate", G_CALLBACK(save_callback), widgets);
     gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
 
+    menu_item = gtk_menu_item_new_with_mnemonic("_Render...");
+    g_signal_connect(G_OBJECT(menu_item), "activate", G_CALLBACK(render_callback), widgets);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+
     menu_item = gtk_separator_menu_item_new();
     gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
 
@@ -195,6 +351,18 @@ create_edit_menu(MainWidgets *widgets)
     GtkWidget *menu, *menu_item;
 
     menu = gtk_menu_new();
+    g_signal_connect(G_OBJECT(menu), "show", G_CALLBACK(edit_menu_callback), widgets);
+
+    widgets->undo_menu_item = gtk_menu_item_new_with_mnemonic("_Undo");
+    g_signal_connect(G_OBJECT(widgets->undo_menu_item), "activate", G_CALLBACK(undo_callback), widgets);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), widgets->undo_menu_item);
+
+    widgets->redo_menu_item = gtk_menu_item_new_with_mnemonic("_Redo");
+    g_signal_connect(G_OBJECT(widgets->redo_menu_item), "activate", G_CALLBACK(redo_callback), widgets);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), widgets->redo_menu_item);
+
+    menu_item = gtk_separator_menu_item_new();
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
 
     menu_item = gtk_menu_item_new_with_mnemonic("_Device...");
     if (midi_get_device_count() > 0) {
@@ -237,6 +405,63 @@ create_edit_menu(MainWidgets *widgets)
     gtk_widget_set_sensitive(GTK_WIDGET(widgets->modes_menu_item), FALSE);
     gtk_menu_shell_append(GTK_MENU_SHELL(menu), widgets->modes_menu_item);
 
+    menu_item = gtk_separator_menu_item_new();
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+
+    widgets->similar_menu_item = gtk_menu_item_new_with_mnemonic("_Similar Patches...");
+    g_signal_connect(G_OBJECT(widgets->similar_menu_item), "activate", G_CALLBACK(similar_callback), widgets);
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->similar_menu_item), FALSE);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), widgets->similar_menu_item);
+
+    widgets->morph_menu_item = gtk_menu_item_new_with_mnemonic("_Morph...");
+    g_signal_connect(G_OBJECT(widgets->morph_menu_item), "activate", G_CALLBACK(morph_callback), widgets);
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->morph_menu_item), FALSE);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), widgets->morph_menu_item);
+
+    widgets->variations_menu_item = gtk_menu_item_new_with_mnemonic("_Variations...");
+    g_signal_connect(G_OBJECT(widgets->variations_menu_item), "activate", G_CALLBACK(variations_callback), widgets);
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->variations_menu_item), FALSE);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), widgets->variations_menu_item);
+
+    widgets->store_a_menu_item = gtk_menu_item_new_with_mnemonic("Store _A");
+    g_signal_connect(G_OBJECT(widgets->store_a_menu_item), "activate", G_CALLBACK(store_a_callback), widgets);
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->store_a_menu_item), FALSE);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), widgets->store_a_menu_item);
+
+    widgets->store_b_menu_item = gtk_menu_item_new_with_mnemonic("Store _B");
+    g_signal_connect(G_OBJECT(widgets->store_b_menu_item), "activate", G_CALLBACK(store_b_callback), widgets);
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->store_b_menu_item), FALSE);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), widgets->store_b_menu_item);
+
+    widgets->switch_menu_item = gtk_menu_item_new_with_mnemonic("S_witch to B");
+    g_signal_connect(G_OBJECT(widgets->switch_menu_item), "activate", G_CALLBACK(switch_callback), widgets);
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->switch_menu_item), FALSE);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), widgets->switch_menu_item);
+
+    widgets->history_menu_item = gtk_menu_item_new_with_mnemonic("_History...");
+    g_signal_connect(G_OBJECT(widgets->history_menu_item), "activate", G_CALLBACK(history_callback), widgets);
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->history_menu_item), FALSE);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), widgets->history_menu_item);
+
+    menu_item = gtk_menu_item_new_with_mnemonic("_Collapse Duplicates");
+    g_signal_connect(G_OBJECT(menu_item), "activate", G_CALLBACK(collapse_callback), widgets);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+
+    menu_item = gtk_menu_item_new_with_mnemonic("Va_lidate Library");
+    g_signal_connect(G_OBJECT(menu_item), "activate", G_CALLBACK(validate_callback), widgets);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+
+    menu_item = gtk_separator_menu_item_new();
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+
+    menu_item = gtk_check_menu_item_new_with_mnemonic("_Preview Note");
+    if (preview_is_running()) {
+        g_signal_connect(G_OBJECT(menu_item), "toggled", G_CALLBACK(preview_callback), widgets);
+    } else {
+        gtk_widget_set_sensitive(GTK_WIDGET(menu_item), FALSE);
+    }
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+
     return menu;
 }
 
@@ -276,15 +501,15 @@ tree_view_callback(GtkTreeSelection *selection, gpointer data)
     GtkTreeIter iter;
     GtkTreeModel *model;
 
+    /* rehash the patch being left, as it may have been edited */
+    if (current_patch) {
+        duplicates_add(widgets->duplicates, current_patch, NULL);
+    }
+
     if (gtk_tree_selection_get_selected(selection, &model, &iter)) {
         gtk_tree_model_get(model, &iter, DATA_COL, &current_patch, -1);
 
-        set_oscillators_parameters(widgets->oscillators_dialog, current_patch);
-        set_lfos_parameters(widgets->lfos_dialog, current_patch);
-        set_filter_parameters(widgets->filter_dialog, current_patch);
-        set_envelopes_parameters(widgets->envelopes_dialog, current_patch);
-        set_amplifier_parameters(widgets->amplifier_dialog, current_patch);
-        set_modes_parameters(widgets->modes_dialog, current_patch);
+        set_dialogs_parameters(widgets, current_patch);
 
         gtk_widget_set_sensitive(GTK_WIDGET(widgets->oscillators_menu_item), TRUE);
         gtk_widget_set_sensitive(GTK_WIDGET(widgets->lfos_menu_item), TRUE);
@@ -292,15 +517,23 @@ tree_view_callback(GtkTreeSelection *selection, gpointer data)
         gtk_widget_set_sensitive(GTK_WIDGET(widgets->envelopes_menu_item), TRUE);
         gtk_widget_set_sensitive(GTK_WIDGET(widgets->amplifier_menu_item), TRUE);
         gtk_widget_set_sensitive(GTK_WIDGET(widgets->modes_menu_item), TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->similar_menu_item), TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->morph_menu_item), TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->variations_menu_item), TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->store_a_menu_item), TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->store_b_menu_item), TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->history_menu_item), TRUE);
     } else {
         current_patch = NULL;
 
+        set_updating(TRUE);
         clear_oscillators_parameters(widgets->oscillators_dialog);
         clear_lfos_parameters(widgets->lfos_dialog);
         clear_filter_parameters(widgets->filter_dialog);
         clear_envelopes_parameters(widgets->envelopes_dialog);
         clear_amplifier_parameters(widgets->amplifier_dialog);
         clear_modes_parameters(widgets->modes_dialog);
+        set_updating(FALSE);
 
         gtk_widget_set_sensitive(GTK_WIDGET(widgets->oscillators_menu_item), FALSE);
         gtk_widget_set_sensitive(GTK_WIDGET(widgets->lfos_menu_item), FALSE);
@@ -308,6 +541,12 @@ tree_view_callback(GtkTreeSelection *selection, gpointer data)
         gtk_widget_set_sensitive(GTK_WIDGET(widgets->envelopes_menu_item), FALSE);
         gtk_widget_set_sensitive(GTK_WIDGET(widgets->amplifier_menu_item), FALSE);
         gtk_widget_set_sensitive(GTK_WIDGET(widgets->modes_menu_item), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->similar_menu_item), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->morph_menu_item), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->variations_menu_item), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->store_a_menu_item), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->store_b_menu_item), FALSE);
+        gtk_widget_set_sensitive(GTK_WIDGET(widgets->history_menu_item), FALSE);
     }
 }
 
@@ -389,6 +628,46 @@ show_callback(GtkWidget *widget, gpointer data)
     }
 }
 
+/*
+ * Enables undo and redo when there are edits to undo and redo, and switching
+ * between A and B when both have been stored for the selected patch.
+ */
+static void
+edit_menu_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->undo_menu_item), widgets->journal->done > 0);
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->redo_menu_item), widgets->journal->done < widgets->journal->count);
+
+    gtk_widget_set_sensitive(GTK_WIDGET(widgets->switch_menu_item), compare_ready(&widgets->compare, current_patch));
+    gtk_menu_item_set_label(GTK_MENU_ITEM(widgets->switch_menu_item), widgets->compare.side == COMPARE_A ? "S_witch to B" : "S_witch to A");
+}
+
+static void
+undo_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+    const JournalRecord *records[PARAMETER_COUNT];
+    gint n;
+
+    if ((n = journal_undo(widgets->journal, records)) > 0) {
+        apply_edits(widgets, records, n, FALSE);
+    }
+}
+
+static void
+redo_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+    const JournalRecord *records[PARAMETER_COUNT];
+    gint n;
+
+    if ((n = journal_redo(widgets->journal, records)) > 0) {
+        apply_edits(widgets, records, n, TRUE);
+    }
+}
+
 static void
 new_callback(GtkWidget *widget, gpointer data)
 {
@@ -419,9 +698,9 @@ new_callback(GtkWidget *widget, gpointer data)
     gtk_widget_show_all(GTK_WIDGET(grid));
 
     if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_OK && strlen(gtk_entry_get_text(GTK_ENTRY(name)))) {
-        patch = g_malloc0(sizeof(Patch));
-        patch->name = g_strdup(gtk_entry_get_text(GTK_ENTRY(name)));
-        patch->type = g_strdup(gtk_entry_get_text(GTK_ENTRY(type)));
+        patch = patch_new();
+        patch_set_name(patch, gtk_entry_get_text(GTK_ENTRY(name)), -1);
+        patch_set_type(patch, gtk_entry_get_text(GTK_ENTRY(type)), -1);
 
         patch->parameters[PARAMETER_OSC1_MOD1_SRC] = 15;
         patch->parameters[PARAMETER_OSC1_MOD2_SRC] = 15;
@@ -456,7 +735,7 @@ new_callback(GtkWidget *widget, gpointer data)
         patch->parameters[PARAMETER_DCA4_PAN] = 8;
         patch->parameters[PARAMETER_DCA4_MOD_SRC] = 15;
 
-        insert_patch(widgets->tree_view, patch);
+        insert_patch(widgets, patch, NULL);
     }
 
     gtk_widget_destroy(dialog);
@@ -467,9 +746,11 @@ open_callback(GtkWidget *widget, gpointer data)
 {
     MainWidgets *widgets;
     GtkWidget *dialog, *message_dialog;
+    GSList *filenames, *list;
     gchar *filename;
     GError *error = NULL;
-    Patch *patch;
+    Patch *patch, *original;
+    gint exact, near;
 
     widgets = data;
 
@@ -479,29 +760,63 @@ open_callback(GtkWidget *widget, gpointer data)
         "_Open", GTK_RESPONSE_ACCEPT,
         "_Cancel", GTK_RESPONSE_CANCEL,
         NULL);
+    gtk_file_chooser_set_select_multiple(GTK_FILE_CHOOSER(dialog), TRUE);
 
     if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
-        filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+        filenames = gtk_file_chooser_get_filenames(GTK_FILE_CHOOSER(dialog));
+
+        /* the patch being edited may no longer match its hash */
+        if (current_patch) {
+            duplicates_add(widgets->duplicates, current_patch, NULL);
+        }
+
+        exact = near = 0;
+
+        for (list = filenames; list; list = list->next) {
+            filename = list->data;
+
+            patch = xmlparser_read(filename, &error);
+
+            if (patch) {
+                patch_set_filename(patch, filename);
+
+                switch (insert_patch(widgets, patch, &original)) {
+                case DUPLICATE_EXACT:
+                    g_print("%s has the same settings as %s\n", patch->name, original->name);
+                    ++exact;
+                    break;
+                case DUPLICATE_NEAR:
+                    g_print("%s has nearly the same settings as %s\n", patch->name, original->name);
+                    ++near;
+                    break;
+                default:
+                    break;
+                }
+            } else {
+                message_dialog = gtk_message_dialog_new(GTK_WINDOW(dialog),
+                    GTK_DIALOG_MODAL,
+                    GTK_MESSAGE_ERROR,
+                    GTK_BUTTONS_CLOSE,
+                    "Unable to load %s", filename);
+                gtk_dialog_run(GTK_DIALOG(message_dialog));
+                gtk_widget_destroy(message_dialog);
+
+                g_print("Unable to load %s:\n%s\n", filename, error->message);
+
+                g_clear_error(&error);
+            }
+        }
 
-        patch = xmlparser_read(filename, &error);
+        g_slist_free_full(filenames, g_free);
 
-        if (patch) {
-            patch->filename = filename;
-            insert_patch(widgets->tree_view, patch);
-        } else {
+        if (exact > 0 || near > 0) {
             message_dialog = gtk_message_dialog_new(GTK_WINDOW(dialog),
                 GTK_DIALOG_MODAL,
-                GTK_MESSAGE_ERROR,
+                GTK_MESSAGE_INFO,
                 GTK_BUTTONS_CLOSE,
-                "Unable to load %s", filename);
+                "%d duplicate and %d near duplicate patches opened", exact, near);
             gtk_dialog_run(GTK_DIALOG(message_dialog));
             gtk_widget_destroy(message_dialog);
-
-            g_print("Unable to load %s:\n%s\n", filename, error->message);
-
-            g_error_free(error);
-
-            g_free(filename);
         }
     }
 
@@ -516,6 +831,9 @@ save_callback(GtkWidget *widget, gpointer data)
     GtkTreeSelection *selection;
     GtkTreeModel *model;
     GtkTreeIter iter;
+    History *history;
+    GError *error = NULL;
+    gchar *filename, *key;
     Patch *patch;
 
     widgets = data;
@@ -534,7 +852,9 @@ save_callback(GtkWidget *widget, gpointer data)
                 NULL);
 
             if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
-                patch->filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+                filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+                patch_set_filename(patch, filename);
+                g_free(filename);
             }
 
             gtk_widget_destroy(dialog);
@@ -550,7 +870,228 @@ save_callback(GtkWidget *widget, gpointer data)
             gtk_widget_destroy(message_dialog);
 
             g_print("Unable to load %s:\n%s\n", patch->filename, strerror(errno));
+        } else if (patch->filename && (history = get_history(widgets, patch))) {
+            key = g_path_get_basename(patch->filename);
+
+            if (!history_append(history, key, patch, &error)) {
+                g_print("Unable to save %s:\n%s\n", history->filename, error->message);
+                g_error_free(error);
+            }
+
+            g_free(key);
+        }
+    }
+}
+
+static void
+render_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets;
+    GtkWidget *dialog, *message_dialog;
+    GtkTreeSelection *selection;
+    GtkTreeModel *model;
+    GtkTreeIter iter;
+    Patch *patch;
+    GError *error = NULL;
+    gchar *filename;
+
+    widgets = data;
+
+    selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widgets->tree_view));
+
+    if (gtk_tree_selection_get_selected(selection, &model, &iter)) {
+        gtk_tree_model_get(model, &iter, DATA_COL, &patch, -1);
+
+        dialog = gtk_file_chooser_dialog_new("Render Patch",
+            GTK_WINDOW(widgets->window),
+            GTK_FILE_CHOOSER_ACTION_SAVE,
+            "_Render", GTK_RESPONSE_ACCEPT,
+            "_Cancel", GTK_RESPONSE_CANCEL,
+            NULL);
+
+        filename = g_strdup_printf("%s.wav", patch->name);
+        gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(dialog), filename);
+        g_free(filename);
+
+        if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+            filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+
+            if (!synth_render(patch, render_notes, render_note_count, render_velocity, render_duration, filename, &error)) {
+                message_dialog = gtk_message_dialog_new(GTK_WINDOW(dialog),
+                    GTK_DIALOG_MODAL,
+                    GTK_MESSAGE_ERROR,
+                    GTK_BUTTONS_CLOSE,
+                    "Unable to render %s", filename);
+                gtk_dialog_run(GTK_DIALOG(message_dialog));
+                gtk_widget_destroy(message_dialog);
+
+                g_print("Unable to render %s:\n%s\n", filename, error->message);
+                g_error_free(error);
+            }
+
+            g_free(filename);
         }
+
+        gtk_widget_destroy(dialog);
+    }
+}
+
+static void
+similar_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+    GtkTreeModel *model;
+    Patch *patch;
+
+    if (!current_patch) {
+        return;
+    }
+
+    model = gtk_tree_view_get_model(GTK_TREE_VIEW(widgets->tree_view));
+
+    if ((patch = run_similar_dialog(GTK_WINDOW(widgets->window), model, current_patch))) {
+        select_patch(widgets->tree_view, patch);
+    }
+}
+
+static void
+collapse_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+    GtkTreeModel *model;
+    GPtrArray *removed;
+    guint i;
+
+    model = gtk_tree_view_get_model(GTK_TREE_VIEW(widgets->tree_view));
+
+    removed = run_collapse_dialog(GTK_WINDOW(widgets->window), GTK_LIST_STORE(model));
+
+    for (i = 0; i < removed->len; ++i) {
+        forget_patch(widgets, g_ptr_array_index(removed, i));
+    }
+
+    g_ptr_array_free(removed, TRUE);
+}
+
+static void
+validate_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+    GtkTreeModel *model;
+
+    model = gtk_tree_view_get_model(GTK_TREE_VIEW(widgets->tree_view));
+
+    if (run_validate_dialog(GTK_WINDOW(widgets->window), model, widgets->duplicates, widgets->journal)) {
+        set_dialogs_parameters(widgets, current_patch);
+    }
+}
+
+static void
+morph_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+    GtkTreeSelection *selection;
+    GtkTreeModel *model;
+    GtkTreeIter iter;
+    Patch *patch;
+
+    selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widgets->tree_view));
+
+    if (!gtk_tree_selection_get_selected(selection, &model, &iter)) {
+        return;
+    }
+
+    if ((patch = run_morph_dialog(GTK_WINDOW(widgets->window), model, &iter))) {
+        insert_patch(widgets, patch, NULL);
+    }
+}
+
+static void
+variations_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+    Patch **patches;
+    gint count;
+
+    if (!current_patch) {
+        return;
+    }
+
+    if ((patches = run_variations_dialog(GTK_WINDOW(widgets->window), current_patch, &count))) {
+        insert_patches(widgets, patches, count);
+        g_free(patches);
+    }
+}
+
+static void
+store_a_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+
+    if (current_patch) {
+        compare_store(&widgets->compare, COMPARE_A, current_patch);
+    }
+}
+
+static void
+store_b_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+
+    if (current_patch) {
+        compare_store(&widgets->compare, COMPARE_B, current_patch);
+    }
+}
+
+/*
+ * Switches the selected patch between its A and B settings, sending only
+ * the parameters that differ.
+ */
+static void
+switch_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+    Compare *compare = &widgets->compare;
+    gint i, n;
+
+    if (!compare_ready(compare, current_patch)) {
+        return;
+    }
+
+    n = compare_switch(compare, widgets->journal);
+
+    for (i = 0; i < n; ++i) {
+        queue_parameter(compare->differing[i], compare->encoded[compare->side][i]);
+    }
+
+    set_dialogs_parameters(widgets, current_patch);
+}
+
+static void
+history_callback(GtkWidget *widget, gpointer data)
+{
+    MainWidgets *widgets = data;
+    History *history;
+
+    if (!current_patch) {
+        return;
+    }
+
+    history = current_patch->filename ? get_history(widgets, current_patch) : NULL;
+
+    if (run_history_dialog(GTK_WINDOW(widgets->window), history, current_patch, widgets->journal)) {
+        set_dialogs_parameters(widgets, current_patch);
+    }
+}
+
+static void
+preview_callback(GtkWidget *widget, gpointer data)
+{
+    /* hold middle C while the item is checked, so slider moves can be heard */
+    if (gtk_check_menu_item_get_active(GTK_CHECK_MENU_ITEM(widget))) {
+        preview_note_on(60, 100);
+    } else {
+        preview_note_off(60);
     }
 }
 
@@ -572,12 +1113,7 @@ close_callback(GtkWidget *widget, gpointer data)
 
         gtk_list_store_remove(GTK_LIST_STORE(model), &iter);
 
-        g_free(patch->name);
-        g_free(patch->type);
-        if (patch->filename) {
-            g_free(patch->filename);
-        }
-        g_free(patch);
+        forget_patch(widgets, patch);
     }
 }
 
@@ -593,8 +1129,12 @@ destroy_callback(GtkWidget *widget, gpointer data)
     gtk_main_quit();
 }
 
-static void
-insert_patch(GtkWidget *tree_view, Patch *new_patch)
+/*
+ * Inserts a patch into the list in order of name, unless a patch from the
+ * same file is already open, and finds whether it duplicates another patch.
+ */
+static DuplicateKind
+insert_patch(MainWidgets *widgets, Patch *new_patch, Patch **original)
 {
     GtkTreeModel *model;
     GtkTreeIter new_iter, iter;
@@ -602,19 +1142,18 @@ insert_patch(GtkWidget *tree_view, Patch *new_patch)
     gboolean valid;
     Patch *patch;
 
-    model = gtk_tree_view_get_model(GTK_TREE_VIEW(tree_view));
+    model = gtk_tree_view_get_model(GTK_TREE_VIEW(widgets->tree_view));
 
     valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(model), &iter);
 
     while (valid) {
         gtk_tree_model_get(GTK_TREE_MODEL(model), &iter, DATA_COL, &patch, -1);
 
-        if (patch->filename && new_patch->filename && strcmp(patch->filename, new_patch->filename) == 0) {
+        /* file names are interned, so the same file has the same name */
+        if (patch->filename && patch->filename == new_patch->filename) {
             new_iter = iter;
-            g_free(new_patch->name);
-            g_free(new_patch->type);
-            g_free(new_patch->filename);
-            g_free(new_patch);
+            patch_free(new_patch);
+            new_patch = NULL;
             break;
         }
 
@@ -640,6 +1179,448 @@ insert_patch(GtkWidget *tree_view, Patch *new_patch)
             -1);
     }
 
-    selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(tree_view));
+    selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widgets->tree_view));
     gtk_tree_selection_select_iter(GTK_TREE_SELECTION(selection), &new_iter);
+
+    if (!new_patch) {
+        return DUPLICATE_NONE;
+    }
+
+    return duplicates_add(widgets->duplicates, new_patch, original);
+}
+
+/*
+ * Inserts new patches, that aren't from files already open, into the list in
+ * order of name. The patches are sorted and merged into the list in one
+ * pass, with the list detached from the tree view so it isn't redrawn for
+ * each one, and the first is selected.
+ */
+static void
+insert_patches(MainWidgets *widgets, Patch **patches, gint count)
+{
+    GtkTreeModel *model;
+    GtkTreeIter new_iter, iter;
+    gboolean valid;
+    Patch *patch;
+    gint i;
+
+    if (count < 1) {
+        return;
+    }
+
+    g_qsort_with_data(patches, count, sizeof(Patch *), compare_patch_names, NULL);
+
+    model = gtk_tree_view_get_model(GTK_TREE_VIEW(widgets->tree_view));
+
+    g_object_ref(model);
+    gtk_tree_view_set_model(GTK_TREE_VIEW(widgets->tree_view), NULL);
+
+    valid = gtk_tree_model_get_iter_first(model, &iter);
+
+    for (i = 0; i < count; ++i) {
+        /* find the first patch after the new one, carrying on from the last */
+        while (valid) {
+            gtk_tree_model_get(model, &iter, DATA_COL, &patch, -1);
+
+            if (g_ascii_strcasecmp(patch->name, patches[i]->name) > 0) {
+                break;
+            }
+
+            valid = gtk_tree_model_iter_next(model, &iter);
+        }
+
+        gtk_list_store_insert_before(GTK_LIST_STORE(model), &new_iter, valid ? &iter : NULL);
+        gtk_list_store_set(GTK_LIST_STORE(model), &new_iter,
+            NAME_COL, patches[i]->name,
+            TYPE_COL, patches[i]->type,
+            DATA_COL, patches[i],
+            -1);
+
+        duplicates_add(widgets->duplicates, patches[i], NULL);
+    }
+
+    gtk_tree_view_set_model(GTK_TREE_VIEW(widgets->tree_view), model);
+    g_object_unref(model);
+
+    select_patch(widgets->tree_view, patches[0]);
+}
+
+static gint
+compare_patch_names(gconstpointer a, gconstpointer b, gpointer data)
+{
+    return g_ascii_strcasecmp((*(Patch **) a)->name, (*(Patch **) b)->name);
+}
+
+/*
+ * Forgets a patch that has been removed from the list, and frees it.
+ */
+static void
+forget_patch(MainWidgets *widgets, Patch *patch)
+{
+    duplicates_remove(widgets->duplicates, patch);
+    journal_forget(widgets->journal, patch);
+    if (widgets->compare.patch == patch) {
+        compare_init(&widgets->compare);
+    }
+
+    patch_free(patch);
+}
+
+static void
+select_patch(GtkWidget *tree_view, Patch *selected_patch)
+{
+    GtkTreeModel *model;
+    GtkTreeIter iter;
+    GtkTreePath *path;
+    gboolean valid;
+    Patch *patch;
+
+    model = gtk_tree_view_get_model(GTK_TREE_VIEW(tree_view));
+
+    valid = gtk_tree_model_get_iter_first(model, &iter);
+
+    while (valid) {
+        gtk_tree_model_get(model, &iter, DATA_COL, &patch, -1);
+
+        if (patch == selected_patch) {
+            gtk_tree_selection_select_iter(gtk_tree_view_get_selection(GTK_TREE_VIEW(tree_view)), &iter);
+
+            path = gtk_tree_model_get_path(model, &iter);
+            gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(tree_view), path, NULL, FALSE, 0, 0);
+            gtk_tree_path_free(path);
+            break;
+        }
+
+        valid = gtk_tree_model_iter_next(model, &iter);
+    }
+}
+
+/*
+ * Sets the widgets of the dialogs and the preview from a patch.
+ */
+static void
+set_dialogs_parameters(MainWidgets *widgets, Patch *patch)
+{
+    /* the widgets only show the patch, whoever changed it sends the values */
+    set_updating(TRUE);
+    set_oscillators_parameters(widgets->oscillators_dialog, patch);
+    set_lfos_parameters(widgets->lfos_dialog, patch);
+    set_filter_parameters(widgets->filter_dialog, patch);
+    set_envelopes_parameters(widgets->envelopes_dialog, patch);
+    set_amplifier_parameters(widgets->amplifier_dialog, patch);
+    set_modes_parameters(widgets->modes_dialog, patch);
+    set_updating(FALSE);
+
+    preview_set_parameters(patch->parameters);
+}
+
+/*
+ * Restores the parameters of a patch from an edit, or group of edits, in the
+ * journal, selecting the patch so the change can be seen and sending the
+ * values through the transmit queue. The values are set before the
+ * widgets, so they don't record them again.
+ */
+static void
+apply_edits(MainWidgets *widgets, const JournalRecord **records, gint count, gboolean redo)
+{
+    Patch *patch = records[0]->patch;
+    guchar value;
+    gint i;
+
+    if (patch != current_patch) {
+        select_patch(widgets->tree_view, patch);
+    }
+
+    for (i = 0; i < count; ++i) {
+        value = redo ? records[i]->new_value : records[i]->old_value;
+        patch->parameters[records[i]->parameter] = value;
+        queue_parameter(records[i]->parameter, parameters_encode(records[i]->parameter, value));
+    }
+
+    set_dialogs_parameters(widgets, patch);
+}
+
+/*
+ * Gets the history of the library a patch was saved in, keeping it open
+ * while patches from the same directory are saved and browsed.
+ */
+static History *
+get_history(MainWidgets *widgets, const Patch *patch)
+{
+    GError *error = NULL;
+    gchar *directory, *path;
+
+    directory = g_path_get_dirname(patch->filename);
+    path = g_build_filename(directory, HISTORY_NAME, NULL);
+    g_free(directory);
+
+    if (widgets->history && strcmp(widgets->history->filename, path) == 0) {
+        g_free(path);
+        return widgets->history;
+    }
+
+    if (widgets->history) {
+        history_free(widgets->history);
+    }
+
+    if (!(widgets->history = history_open(path, &error))) {
+        g_print("Unable to load %s:\n%s\n", path, error->message);
+        g_error_free(error);
+    }
+
+    g_free(path);
+
+    return widgets->history;
+}
+
+/*
+ * Fills in the notes to render from the chord option if it was given, or
+ * the note option if it wasn't.
+ */
+static gboolean
+parse_notes(void)
+{
+    gchar **notes, *ptr;
+    gint i;
+
+    if (!render_chord) {
+        render_notes[0] = render_note;
+        render_note_count = 1;
+        return render_note >= 0 && render_note <= 127;
+    }
+
+    notes = g_strsplit(render_chord, ",", -1);
+
+    for (i = 0; notes[i] && render_note_count < SYNTH_VOICE_COUNT; ++i) {
+        render_notes[render_note_count] = strtol(notes[i], &ptr, 10);
+        if (notes[i][0] == '\0' || *ptr != '\0' || render_notes[render_note_count] < 0 || render_notes[render_note_count] > 127) {
+            g_strfreev(notes);
+            return FALSE;
+        }
+        ++render_note_count;
+    }
+
+    g_strfreev(notes);
+
+    return render_note_count > 0;
+}
+
+/*
+ * Renders a patch from the command line, so patches can be auditioned on
+ * machines without a display or MIDI devices.
+ */
+static int
+render_patch(const gchar *filename)
+{
+    Patch *patch;
+    GError *error = NULL;
+    int status = 0;
+
+    if (!(patch = xmlparser_read(filename, &error))) {
+        g_printerr("Unable to load %s:\n%s\n", filename, error->message);
+        g_error_free(error);
+        return 1;
+    }
+
+    if (!synth_render(patch, render_notes, render_note_count, render_velocity, render_duration, render_filename, &error)) {
+        g_printerr("Unable to render %s:\n%s\n", render_filename, error->message);
+        g_error_free(error);
+        status = 1;
+    }
+
+    patch_free(patch);
+
+    return status;
+}
+
+/*
+ * Renders a library of patches from the command line, reporting the
+ * throughput so that large batches can be planned.
+ */
+static int
+render_patches(gchar **paths, gint count)
+{
+    GPtrArray *filenames, *names;
+    BatchResult result;
+
+    filenames = batch_find_patches(paths, count, &names);
+
+    if (filenames->len == 0) {
+        g_printerr("No patches to render\n");
+        g_ptr_array_free(filenames, TRUE);
+        g_ptr_array_free(names, TRUE);
+        return 1;
+    }
+
+    if (!g_file_test(render_directory, G_FILE_TEST_IS_DIR) && g_mkdir_with_parents(render_directory, 0755) != 0) {
+        g_printerr("Unable to create %s:\n%s\n", render_directory, strerror(errno));
+        g_ptr_array_free(filenames, TRUE);
+        g_ptr_array_free(names, TRUE);
+        return 1;
+    }
+
+    batch_render(filenames, names, render_directory, render_threads, render_notes, render_note_count, render_velocity, render_duration, &result);
+
+    g_print("Rendered %d of %u patches in %.2f seconds (%.1f patches per second)\n",
+        result.rendered, filenames->len, result.seconds,
+        result.seconds > 0 ? result.rendered / result.seconds : 0.0);
+
+    g_ptr_array_free(filenames, TRUE);
+    g_ptr_array_free(names, TRUE);
+
+    return result.failed ? 1 : 0;
+}
+
+/*
+ * Renders a short note with each patch and saves their fingerprints in an
+ * index, for finding patches that sound alike. The patches are rendered by
+ * the batch threads, then added to the index in the order they were found.
+ */
+static int
+index_patches(gchar **paths, gint count)
+{
+    FingerprintIndex *index;
+    IndexBatch batch;
+    BatchResult result;
+    GError *error = NULL;
+    guint i;
+    int status;
+
+    batch.filenames = batch_find_patches(paths, count, NULL);
+
+    if (batch.filenames->len == 0) {
+        g_printerr("No patches to index\n");
+        g_ptr_array_free(batch.filenames, TRUE);
+        return 1;
+    }
+
+    batch.vectors = g_new(gfloat, (gsize) batch.filenames->len * FINGERPRINT_LENGTH);
+    batch.indexed = g_new0(gboolean, batch.filenames->len);
+
+    batch_run(batch.filenames->len, render_threads, index_patch, &batch, &result);
+
+    index = fingerprint_index_new();
+
+    for (i = 0; i < batch.filenames->len; ++i) {
+        if (batch.indexed[i]) {
+            fingerprint_index_add(index, g_ptr_array_index(batch.filenames, i), batch.vectors + (gsize) i * FINGERPRINT_LENGTH);
+        }
+    }
+
+    g_print("Indexed %u of %u patches in %.2f seconds (%.1f patches per second)\n",
+        index->count, batch.filenames->len, result.seconds,
+        result.seconds > 0 ? result.rendered / result.seconds : 0.0);
+
+    status = result.failed ? 1 : 0;
+
+    if (!fingerprint_index_save(index, index_filename, &error)) {
+        g_printerr("Unable to save %s:\n%s\n", index_filename, error->message);
+        g_error_free(error);
+        status = 1;
+    }
+
+    fingerprint_index_free(index);
+    g_free(batch.indexed);
+    g_free(batch.vectors);
+    g_ptr_array_free(batch.filenames, TRUE);
+
+    return status;
+}
+
+/*
+ * Computes the fingerprint of one patch of an index, called from the batch
+ * threads.
+ */
+static gboolean
+index_patch(gint i, gpointer data)
+{
+    IndexBatch *batch = data;
+    Patch *patch;
+    GError *error = NULL;
+    const gchar *filename;
+
+    filename = g_ptr_array_index(batch->filenames, i);
+
+    if (!(patch = xmlparser_read(filename, &error))) {
+        g_printerr("Unable to load %s:\n%s\n", filename, error->message);
+        g_error_free(error);
+        return FALSE;
+    }
+
+    fingerprint_compute(patch->parameters, batch->vectors + (gsize) i * FINGERPRINT_LENGTH);
+    batch->indexed[i] = TRUE;
+
+    patch_free(patch);
+
+    return TRUE;
+}
+
+/*
+ * Lists the patches that sound most like a patch, from the index given
+ * with the index option or the index in the directory of the patch.
+ */
+static int
+find_similar(const gchar *filename)
+{
+    FingerprintIndex *index;
+    FingerprintMatch matches[SIMILAR_COUNT + 1];
+    Patch *patch;
+    GError *error = NULL;
+    GTimer *timer;
+    gfloat vector[FINGERPRINT_LENGTH];
+    gchar *directory, *path, *query, *match;
+    gint i, n, listed;
+
+    if (!(patch = xmlparser_read(filename, &error))) {
+        g_printerr("Unable to load %s:\n%s\n", filename, error->message);
+        g_error_free(error);
+        return 1;
+    }
+
+    fingerprint_compute(patch->parameters, vector);
+
+    patch_free(patch);
+
+    if (index_filename) {
+        path = g_strdup(index_filename);
+    } else {
+        directory = g_path_get_dirname(filename);
+        path = g_build_filename(directory, FINGERPRINT_INDEX_NAME, NULL);
+        g_free(directory);
+    }
+
+    if (!(index = fingerprint_index_load(path, &error))) {
+        g_printerr("Unable to load %s:\n%s\n", path, error->message);
+        g_error_free(error);
+        g_free(path);
+        return 1;
+    }
+
+    /* one extra, as the patch is its own closest match if it is indexed */
+    timer = g_timer_new();
+    n = fingerprint_index_search(index, vector, matches, SIMILAR_COUNT + 1);
+    g_timer_stop(timer);
+
+    query = g_canonicalize_filename(filename, NULL);
+
+    for (listed = 0, i = 0; i < n && listed < SIMILAR_COUNT; ++i) {
+        match = g_canonicalize_filename(g_ptr_array_index(index->filenames, matches[i].index), NULL);
+
+        if (g_strcmp0(match, query) != 0) {
+            g_print("%8.4f  %s\n", matches[i].distance, (gchar *) g_ptr_array_index(index->filenames, matches[i].index));
+            ++listed;
+        }
+
+        g_free(match);
+    }
+
+    g_free(query);
+
+    g_print("Searched %u patches in %.2f milliseconds\n", index->count, g_timer_elapsed(timer, NULL) * 1000);
+
+    g_timer_destroy(timer);
+    fingerprint_index_free(index);
+    g_free(path);
+
+    return 0;
 }
@@ -194,8 +194,16 @@ typedef enum {
     PARAMETER_COUNT
 } Parameters;
 
+/* Sizes of the name and type held in a patch, including the nul */
+#define PATCH_NAME_SIZE 24
+#define PATCH_TYPE_SIZE 16
+
 typedef struct {
-    gchar *filename, *name, *type;
+    const gchar *filename;
+    gchar *name;
+    gchar *type;
+    gchar name_buffer[PATCH_NAME_SIZE];
+    gchar type_buffer[PATCH_TYPE_SIZE];
     guchar parameters[PARAMETER_COUNT];
 } Patch;
 
@@ -17,14 +17,11 @@
 #include <gtk/gtk.h>
 
 #include "main.h"
+#include "parameters.h"
+#include "journal.h"
 #include "dialog.h"
 #include "modes.h"
 
-static ScaleParams glide_params = {
-    .parameter = PARAMETER_GLIDE,
-    .multiplier = 2
-};
-
 ModesDialog *
 new_modes_dialog(GtkWindow *parent)
 {
@@ -44,7 +41,7 @@ new_modes_dialog(GtkWindow *parent)
     create_grid_row(grid, 0, GTK_LABEL(label), GTK_WIDGET(widgets->amplitude_modulation));
 
     label = gtk_label_new("Glide:");
-    widgets->glide = create_hscale_with_params(0, 63, &glide_params);
+    widgets->glide = create_hscale(PARAMETER_GLIDE);
     create_grid_row(grid, 1, GTK_LABEL(label), GTK_WIDGET(widgets->glide));
 
     label = gtk_label_new("Mono:");
@@ -103,7 +100,7 @@ set_modes_parameters(ModesDialog *widgets, Patch *patch)
         patch->parameters[PARAMETER_ENVELOPE_FULL_CYCLE]);
 
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->amplitude_modulation), patch->parameters[PARAMETER_AMPLITUDE_MODULATION] ? TRUE : FALSE);
-    gtk_range_set_value(GTK_RANGE(widgets->glide), patch->parameters[PARAMETER_GLIDE]);
+    gtk_range_set_value(GTK_RANGE(widgets->glide), parameters_decode(PARAMETER_GLIDE, patch->parameters[PARAMETER_GLIDE]));
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->mono), patch->parameters[PARAMETER_MONO] ? TRUE : FALSE);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->sync), patch->parameters[PARAMETER_SYNC] ? TRUE : FALSE);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->voice_restart), patch->parameters[PARAMETER_VOICE_RESTART] ? TRUE : FALSE);
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "modmatrix.h"
+
+typedef struct {
+    Parameters source;
+    Parameters depth;
+    ModDestination destination;
+} ModRoute;
+
+/* The routes in a patch, with no depth parameter for the LFO routes */
+static const ModRoute routes[MODMATRIX_ROUTE_COUNT] = {
+    { PARAMETER_OSC1_MOD1_SRC, PARAMETER_OSC1_MOD1_DEPTH, MOD_OSC1_PITCH },
+    { PARAMETER_OSC1_MOD2_SRC, PARAMETER_OSC1_MOD2_DEPTH, MOD_OSC1_PITCH },
+    { PARAMETER_OSC2_MOD1_SRC, PARAMETER_OSC2_MOD1_DEPTH, MOD_OSC2_PITCH },
+    { PARAMETER_OSC2_MOD2_SRC, PARAMETER_OSC2_MOD2_DEPTH, MOD_OSC2_PITCH },
+    { PARAMETER_OSC3_MOD1_SRC, PARAMETER_OSC3_MOD1_DEPTH, MOD_OSC3_PITCH },
+    { PARAMETER_OSC3_MOD2_SRC, PARAMETER_OSC3_MOD2_DEPTH, MOD_OSC3_PITCH },
+    { PARAMETER_DCA1_MOD1_SRC, PARAMETER_DCA1_MOD1_DEPTH, MOD_DCA1_LEVEL },
+    { PARAMETER_DCA1_MOD2_SRC, PARAMETER_DCA1_MOD2_DEPTH, MOD_DCA1_LEVEL },
+    { PARAMETER_DCA2_MOD1_SRC, PARAMETER_DCA2_MOD1_DEPTH, MOD_DCA2_LEVEL },
+    { PARAMETER_DCA2_MOD2_SRC, PARAMETER_DCA2_MOD2_DEPTH, MOD_DCA2_LEVEL },
+    { PARAMETER_DCA3_MOD1_SRC, PARAMETER_DCA3_MOD1_DEPTH, MOD_DCA3_LEVEL },
+    { PARAMETER_DCA3_MOD2_SRC, PARAMETER_DCA3_MOD2_DEPTH, MOD_DCA3_LEVEL },
+    { PARAMETER_FILTER_MOD1_SRC, PARAMETER_FILTER_MOD1_DEPTH, MOD_FILTER_FREQUENCY },
+    { PARAMETER_FILTER_MOD2_SRC, PARAMETER_FILTER_MOD2_DEPTH, MOD_FILTER_FREQUENCY },
+    { PARAMETER_DCA4_MOD_SRC, PARAMETER_DCA4_MOD_DEPTH, MOD_PAN },
+    { PARAMETER_LFO1_MOD_SRC, PARAMETER_COUNT, MOD_LFO1_LEVEL },
+    { PARAMETER_LFO2_MOD_SRC, PARAMETER_COUNT, MOD_LFO2_LEVEL },
+    { PARAMETER_LFO3_MOD_SRC, PARAMETER_COUNT, MOD_LFO3_LEVEL }
+};
+
+/**
+   \brief Compiles the modulation routes of a patch, leaving out the routes
+   that can have no effect because their source is Off or their depth is
+   zero.
+
+   \param matrix - the compiled routes.
+   \param parameters - the parameters of the patch.
+ */
+void
+modmatrix_compile(ModMatrix *matrix, const guchar *parameters)
+{
+    const ModRoute *route;
+    gint source, depth, i;
+
+    matrix->count = 0;
+
+    for (i = 0; i < MODMATRIX_ROUTE_COUNT; ++i) {
+        route = &routes[i];
+        source = parameters[route->source];
+        depth = route->depth == PARAMETER_COUNT ? 63 : (gint8) parameters[route->depth];
+
+        if (source >= MODMATRIX_SOURCE_OFF || depth == 0) {
+            continue;
+        }
+
+        matrix->sources[matrix->count] = source;
+        matrix->destinations[matrix->count] = route->destination;
+        matrix->depths[matrix->count] = depth / 63.0f;
+        ++matrix->count;
+    }
+}
+
+/**
+   \brief Evaluates the compiled routes for a block, summing the scaled
+   sources for each destination. The values are held for each voice, with
+   the voices of a source or destination next to each other.
+
+   \param matrix - the compiled routes.
+   \param sources - the values of the sources, MODMATRIX_SOURCE_COUNT by voices.
+   \param destinations - the values of the destinations, MOD_DESTINATION_COUNT
+   by voices.
+   \param voices - the number of voices.
+ */
+void
+modmatrix_evaluate(const ModMatrix *matrix, const gfloat *sources, gfloat *destinations, gint voices)
+{
+    const gfloat *source;
+    gfloat *destination, depth;
+    gint i, v;
+
+    memset(destinations, 0, MOD_DESTINATION_COUNT * voices * sizeof(gfloat));
+
+    for (i = 0; i < matrix->count; ++i) {
+        source = sources + matrix->sources[i] * voices;
+        destination = destinations + matrix->destinations[i] * voices;
+        depth = matrix->depths[i];
+        for (v = 0; v < voices; ++v) {
+            destination[v] += source[v] * depth;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef MODMATRIX_H
+#define MODMATRIX_H
+
+/* Number of modulation sources, including Off */
+#define MODMATRIX_SOURCE_COUNT 16
+
+/* Index of the Off source in the modulation source combo boxes */
+#define MODMATRIX_SOURCE_OFF 15
+
+typedef enum {
+    MOD_OSC1_PITCH,
+    MOD_OSC2_PITCH,
+    MOD_OSC3_PITCH,
+    MOD_DCA1_LEVEL,
+    MOD_DCA2_LEVEL,
+    MOD_DCA3_LEVEL,
+    MOD_FILTER_FREQUENCY,
+    MOD_PAN,
+    MOD_LFO1_LEVEL,
+    MOD_LFO2_LEVEL,
+    MOD_LFO3_LEVEL,
+    MOD_DESTINATION_COUNT
+} ModDestination;
+
+/* Number of routes in a patch, two for each oscillator, DCA and the filter */
+#define MODMATRIX_ROUTE_COUNT 18
+
+typedef struct {
+    gint count;
+    guchar sources[MODMATRIX_ROUTE_COUNT];
+    guchar destinations[MODMATRIX_ROUTE_COUNT];
+    gfloat depths[MODMATRIX_ROUTE_COUNT];
+} ModMatrix;
+
+void modmatrix_compile(ModMatrix *, const guchar *);
+void modmatrix_evaluate(const ModMatrix *, const gfloat *, gfloat *, gint);
+
+#endif /* !MODMATRIX_H */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "parameters.h"
+#include "morph.h"
+
+/**
+   \brief Starts a morph from the values the synth is sounding, so only
+   parameters that differ from them are ever sent.
+
+   \param morph - the morph.
+   \param sounding - the parameters of the patch the synth is sounding.
+   \param threshold - the crossfader position, from 0 to 1, at which waves,
+   mod sources and switches change from the first patch to the second.
+ */
+void
+morph_init(Morph *morph, const guchar *sounding, gdouble threshold)
+{
+    memcpy(morph->values, sounding, PARAMETER_COUNT);
+    morph->differing_count = 0;
+    morph->threshold = CLAMP(threshold, 0.0, 1.0);
+}
+
+/**
+   \brief Sets the patches to morph between. The next step only reports
+   parameters that differ from the values already sent, so changing patches
+   mid morph costs no more than moving the crossfader.
+
+   \param morph - the morph.
+   \param from - the parameters of the patch at the start of the crossfader.
+   \param to - the parameters of the patch at the end of the crossfader.
+ */
+void
+morph_set_patches(Morph *morph, const guchar *from, const guchar *to)
+{
+    gint i;
+
+    memcpy(morph->from, from, PARAMETER_COUNT);
+    memcpy(morph->to, to, PARAMETER_COUNT);
+
+    /* other parameters can't change, so are never looked at again */
+    morph->differing_count = 0;
+    for (i = 0; i < PARAMETER_COUNT; ++i) {
+        if (from[i] != to[i] || morph->values[i] != from[i]) {
+            morph->differing[morph->differing_count++] = i;
+        }
+    }
+}
+
+/**
+   \brief Moves the crossfader of a morph and finds the parameters whose
+   values have changed.
+
+   \param morph - the morph, whose values are updated.
+   \param position - the crossfader position, from 0 to 1.
+   \param changed - the changed parameters to fill in, PARAMETER_COUNT long.
+   \return the number of changed parameters.
+ */
+gint
+morph_step(Morph *morph, gdouble position, guchar *changed)
+{
+    gint i, j, n, a, b;
+    guchar value;
+
+    position = CLAMP(position, 0.0, 1.0);
+
+    n = 0;
+
+    for (j = 0; j < morph->differing_count; ++j) {
+        i = morph->differing[j];
+
+        switch (parameter_descriptors[i].kind) {
+        case DESCRIPTOR_UNSIGNED:
+            value = lround(morph->from[i] + (morph->to[i] - morph->from[i]) * position);
+            break;
+        case DESCRIPTOR_SIGNED:
+            a = (gint8) morph->from[i];
+            b = (gint8) morph->to[i];
+            value = (guchar) (gint8) lround(a + (b - a) * position);
+            break;
+        default:
+            value = position < morph->threshold ? morph->from[i] : morph->to[i];
+            break;
+        }
+
+        if (value != morph->values[i]) {
+            morph->values[i] = value;
+            changed[n++] = i;
+        }
+    }
+
+    return n;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef MORPH_H
+#define MORPH_H
+
+/* Crossfader position at which waves, mod sources and switches change over */
+#define MORPH_DEFAULT_THRESHOLD 0.5
+
+typedef struct {
+    guchar from[PARAMETER_COUNT];
+    guchar to[PARAMETER_COUNT];
+    guchar values[PARAMETER_COUNT];
+    guchar differing[PARAMETER_COUNT];
+    gint differing_count;
+    gdouble threshold;
+} Morph;
+
+void morph_init(Morph *, const guchar *, gdouble);
+void morph_set_patches(Morph *, const guchar *, const guchar *);
+gint morph_step(Morph *, gdouble, guchar *);
+
+#endif /* !MORPH_H */
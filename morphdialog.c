@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "patch.h"
+#include "parameters.h"
+#include "dialog.h"
+#include "morph.h"
+#include "preview.h"
+#include "morphdialog.h"
+
+typedef struct {
+    GtkWidget *from;
+    GtkWidget *to;
+    GtkWidget *crossfader;
+    Morph morph;
+} MorphWidgets;
+
+static void patches_callback(GtkWidget *, gpointer);
+static void crossfader_callback(GtkWidget *, gpointer);
+static GtkWidget *create_patch_combo_box(GtkTreeModel *);
+
+/*
+ * Morphs the synth between two patches with a crossfader, starting from the
+ * selected patch, and sending only the parameters that change. Returns the
+ * result as a new patch if asked to keep it, or puts the synth back to the
+ * patch being edited and returns NULL if not.
+ */
+Patch *
+run_morph_dialog(GtkWindow *parent, GtkTreeModel *patches, GtkTreeIter *selected)
+{
+    MorphWidgets widgets;
+    GtkWidget *dialog, *label;
+    GtkGrid *grid;
+    GtkTreeIter iter;
+    Patch *patch, *from;
+    gint i;
+
+    dialog = gtk_dialog_new_with_buttons("Morph",
+        parent,
+        GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+        "_Keep", GTK_RESPONSE_ACCEPT,
+        "_Close", GTK_RESPONSE_CLOSE,
+        NULL);
+
+    grid = create_grid(GTK_CONTAINER(gtk_dialog_get_content_area(GTK_DIALOG(dialog))));
+
+    /* morph from the selected patch to the one after it */
+    iter = *selected;
+
+    label = gtk_label_new("From:");
+    widgets.from = create_patch_combo_box(patches);
+    gtk_combo_box_set_active_iter(GTK_COMBO_BOX(widgets.from), &iter);
+    create_grid_row(grid, 0, GTK_LABEL(label), widgets.from);
+
+    if (!gtk_tree_model_iter_next(patches, &iter)) {
+        gtk_tree_model_get_iter_first(patches, &iter);
+    }
+
+    label = gtk_label_new("To:");
+    widgets.to = create_patch_combo_box(patches);
+    gtk_combo_box_set_active_iter(GTK_COMBO_BOX(widgets.to), &iter);
+    create_grid_row(grid, 1, GTK_LABEL(label), widgets.to);
+
+    label = gtk_label_new("Crossfader:");
+    widgets.crossfader = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 100, 1);
+    gtk_widget_set_size_request(widgets.crossfader, 256, -1);
+    create_grid_row(grid, 2, GTK_LABEL(label), widgets.crossfader);
+
+    /* start from the patch the synth is sounding, so only differences are sent */
+    gtk_tree_model_get(patches, selected, DATA_COL, &from, -1);
+    morph_init(&widgets.morph, current_patch ? current_patch->parameters : from->parameters, MORPH_DEFAULT_THRESHOLD);
+    patches_callback(NULL, &widgets);
+
+    g_signal_connect(G_OBJECT(widgets.from), "changed", G_CALLBACK(patches_callback), &widgets);
+    g_signal_connect(G_OBJECT(widgets.to), "changed", G_CALLBACK(patches_callback), &widgets);
+    g_signal_connect(G_OBJECT(widgets.crossfader), "value-changed", G_CALLBACK(crossfader_callback), &widgets);
+
+    gtk_widget_show_all(GTK_WIDGET(grid));
+
+    patch = NULL;
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        gtk_combo_box_get_active_iter(GTK_COMBO_BOX(widgets.from), &iter);
+        gtk_tree_model_get(patches, &iter, DATA_COL, &from, -1);
+
+        patch = patch_new();
+        patch_set_name(patch, "Morph", -1);
+        patch_set_type(patch, from->type, -1);
+        memcpy(patch->parameters, widgets.morph.values, PARAMETER_COUNT);
+    } else if (current_patch) {
+        /* put the synth back to the patch being edited */
+        for (i = 0; i < PARAMETER_COUNT; ++i) {
+            if (widgets.morph.values[i] != current_patch->parameters[i]) {
+                queue_parameter(i, parameters_encode(i, current_patch->parameters[i]));
+            }
+        }
+
+        preview_set_parameters(current_patch->parameters);
+    }
+
+    gtk_widget_destroy(dialog);
+
+    return patch;
+}
+
+static void
+patches_callback(GtkWidget *widget, gpointer data)
+{
+    MorphWidgets *widgets = data;
+    GtkTreeModel *model;
+    GtkTreeIter iter;
+    Patch *from, *to;
+
+    model = gtk_combo_box_get_model(GTK_COMBO_BOX(widgets->from));
+
+    if (!gtk_combo_box_get_active_iter(GTK_COMBO_BOX(widgets->from), &iter)) {
+        return;
+    }
+    gtk_tree_model_get(model, &iter, DATA_COL, &from, -1);
+
+    if (!gtk_combo_box_get_active_iter(GTK_COMBO_BOX(widgets->to), &iter)) {
+        return;
+    }
+    gtk_tree_model_get(model, &iter, DATA_COL, &to, -1);
+
+    morph_set_patches(&widgets->morph, from->parameters, to->parameters);
+
+    crossfader_callback(widgets->crossfader, widgets);
+}
+
+static void
+crossfader_callback(GtkWidget *widget, gpointer data)
+{
+    MorphWidgets *widgets = data;
+    guchar changed[PARAMETER_COUNT], encoded[PARAMETER_COUNT];
+    gint i, n;
+
+    n = morph_step(&widgets->morph, gtk_range_get_value(GTK_RANGE(widget)) / 100.0, changed);
+
+    if (n > 0) {
+        parameters_encode_all(widgets->morph.values, encoded);
+    }
+
+    /* the queue keeps the latest value of each and paces them to the link */
+    for (i = 0; i < n; ++i) {
+        queue_parameter(changed[i], encoded[changed[i]]);
+    }
+
+    if (n > 0) {
+        preview_set_parameters(widgets->morph.values);
+    }
+}
+
+static GtkWidget *
+create_patch_combo_box(GtkTreeModel *model)
+{
+    GtkWidget *combo_box;
+    GtkCellRenderer *renderer;
+
+    combo_box = gtk_combo_box_new_with_model(model);
+
+    renderer = gtk_cell_renderer_text_new();
+    gtk_cell_layout_pack_start(GTK_CELL_LAYOUT(combo_box), renderer, TRUE);
+    gtk_cell_layout_set_attributes(GTK_CELL_LAYOUT(combo_box), renderer, "text", NAME_COL, NULL);
+
+    return combo_box;
+}
@@ -0,0 +1,476 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "parameters.h"
+
+/* The modulation sources, shared by every mod source */
+static const gchar *const mod_srcs[] = {
+    "LFO 1",
+    "LFO 2",
+    "LFO 3",
+    "Envelope 1",
+    "Envelope 2",
+    "Envelope 3",
+    "Envelope 4",
+    "Velocity",
+    "Velocity X",
+    "Keyboard",
+    "Keyboard 2",
+    "Modulation Wheel",
+    "Foot Pedal",
+    "External Controller",
+    "Pressure",
+    "Off"
+};
+
+static const gchar *const lfo_waves[] = {
+    "Triangle",
+    "Sawtooth",
+    "Square",
+    "Noise"
+};
+
+static const gchar *const oscillator_waves[] = {
+    /* Following waves are common to the ESQ-1 and SQ-80 */
+    "Sawtooth",
+    "Bell",
+    "Sine",
+    "Square",
+    "Pulse",
+    "Noise 1",
+    "Noise 2",
+    "Noise 3",
+    "Bass",
+    "Piano",
+    "Electric Piano",
+    "Voice 1",
+    "Voice 2",
+    "Kick",
+    "Reed",
+    "Organ",
+    "Synth 1",
+    "Synth 2",
+    "Synth 3",
+    "Formant 1",
+    "Formant 2",
+    "Formant 3",
+    "Formant 4",
+    "Formant 5",
+    "Pulse 2",
+    "Square 2",
+    "Four Octaves",
+    "Prime",
+    "Bass 2",
+    "Electric Piano 2",
+    "Octave",
+    "Octave And Fifth",
+    /* Following waves are specific to the SQ-80 */
+    "Sawtooth 2",
+    "Triangle",
+    "Reed 2",
+    "Reed 3",
+    "Grit 1",
+    "Grit 2",
+    "Grit 3",
+    "Glint 1",
+    "Glint 2",
+    "Glint 3",
+    "Clav",
+    "Brass",
+    "String",
+    "Digit 1",
+    "Digit 2",
+    "Bell 2",
+    "Alien",
+    "Breath",
+    "Voice 3",
+    "Steam",
+    "Metal",
+    "Chime",
+    "Bowing",
+    "Pick 1",
+    "Pick 2",
+    "Mallet",
+    "Slap",
+    "Plink",
+    "Pluck",
+    "Plunk",
+    "Click",
+    "Chiff",
+    "Thump",
+    "Log Drum",
+    "Kick 2",
+    "Snare",
+    "Tom Tom",
+    "Hi Hat",
+    "Drums 1",
+    "Drums 2",
+    "Drums 3",
+    "Drums 4",
+    "Drums 5"
+};
+
+/*
+ * The ranges of the parameters as unsigned bytes, with the sign bit of signed
+ * values flipped, so every range can be checked with the same comparisons.
+ */
+static guchar biases[PARAMETER_COUNT];
+static guchar lowers[PARAMETER_COUNT];
+static guchar uppers[PARAMETER_COUNT];
+
+/*
+ * The descriptors of every parameter, in NRPN order. Each gives the range
+ * of values its widget shows and how they are sent to the synth.
+ */
+const ParameterDescriptor parameter_descriptors[PARAMETER_COUNT] = {
+    /* Envelope 1 */
+    [PARAMETER_ENV1_LEVEL1] = { "Envelope 1 Level 1", 0, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV1_LEVEL2] = { "Envelope 1 Level 2", 1, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV1_LEVEL3] = { "Envelope 1 Level 3", 2, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV1_VELOCITY_LEVEL] = { "Envelope 1 Velocity Level", 3, DESCRIPTOR_UNSIGNED, 0, 127, 0, 1, 1, NULL },
+    [PARAMETER_ENV1_VELOCITY_ATTACK] = { "Envelope 1 Velocity Attack", 4, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV1_TIME1] = { "Envelope 1 Time 1", 5, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV1_TIME2] = { "Envelope 1 Time 2", 6, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV1_TIME3] = { "Envelope 1 Time 3", 7, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV1_TIME4] = { "Envelope 1 Time 4", 8, DESCRIPTOR_UNSIGNED, 0, 127, 0, 1, 1, NULL },
+    [PARAMETER_ENV1_KEYBOARD_DECAY_SCALING] = { "Envelope 1 Keyboard Decay Scaling", 9, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+
+    /* Envelope 2 */
+    [PARAMETER_ENV2_LEVEL1] = { "Envelope 2 Level 1", 10, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV2_LEVEL2] = { "Envelope 2 Level 2", 11, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV2_LEVEL3] = { "Envelope 2 Level 3", 12, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV2_VELOCITY_LEVEL] = { "Envelope 2 Velocity Level", 13, DESCRIPTOR_UNSIGNED, 0, 127, 0, 1, 1, NULL },
+    [PARAMETER_ENV2_VELOCITY_ATTACK] = { "Envelope 2 Velocity Attack", 14, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV2_TIME1] = { "Envelope 2 Time 1", 15, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV2_TIME2] = { "Envelope 2 Time 2", 16, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV2_TIME3] = { "Envelope 2 Time 3", 17, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV2_TIME4] = { "Envelope 2 Time 4", 18, DESCRIPTOR_UNSIGNED, 0, 127, 0, 1, 1, NULL },
+    [PARAMETER_ENV2_KEYBOARD_DECAY_SCALING] = { "Envelope 2 Keyboard Decay Scaling", 19, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+
+    /* Envelope 3 */
+    [PARAMETER_ENV3_LEVEL1] = { "Envelope 3 Level 1", 20, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV3_LEVEL2] = { "Envelope 3 Level 2", 21, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV3_LEVEL3] = { "Envelope 3 Level 3", 22, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV3_VELOCITY_LEVEL] = { "Envelope 3 Velocity Level", 23, DESCRIPTOR_UNSIGNED, 0, 127, 0, 1, 1, NULL },
+    [PARAMETER_ENV3_VELOCITY_ATTACK] = { "Envelope 3 Velocity Attack", 24, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV3_TIME1] = { "Envelope 3 Time 1", 25, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV3_TIME2] = { "Envelope 3 Time 2", 26, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV3_TIME3] = { "Envelope 3 Time 3", 27, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV3_TIME4] = { "Envelope 3 Time 4", 28, DESCRIPTOR_UNSIGNED, 0, 127, 0, 1, 1, NULL },
+    [PARAMETER_ENV3_KEYBOARD_DECAY_SCALING] = { "Envelope 3 Keyboard Decay Scaling", 29, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+
+    /* Envelope 4 */
+    [PARAMETER_ENV4_LEVEL1] = { "Envelope 4 Level 1", 30, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV4_LEVEL2] = { "Envelope 4 Level 2", 31, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV4_LEVEL3] = { "Envelope 4 Level 3", 32, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_ENV4_VELOCITY_LEVEL] = { "Envelope 4 Velocity Level", 33, DESCRIPTOR_UNSIGNED, 0, 127, 0, 1, 1, NULL },
+    [PARAMETER_ENV4_VELOCITY_ATTACK] = { "Envelope 4 Velocity Attack", 34, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV4_TIME1] = { "Envelope 4 Time 1", 35, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV4_TIME2] = { "Envelope 4 Time 2", 36, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV4_TIME3] = { "Envelope 4 Time 3", 37, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_ENV4_TIME4] = { "Envelope 4 Time 4", 38, DESCRIPTOR_UNSIGNED, 0, 127, 0, 1, 1, NULL },
+    [PARAMETER_ENV4_KEYBOARD_DECAY_SCALING] = { "Envelope 4 Keyboard Decay Scaling", 39, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+
+    /* LFO 1 */
+    [PARAMETER_LFO1_FREQUENCY] = { "LFO 1 Frequency", 40, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO1_RESET] = { "LFO 1 Reset", 41, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL },
+    [PARAMETER_LFO1_HUMAN] = { "LFO 1 Human", 42, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL },
+    [PARAMETER_LFO1_WAVE] = { "LFO 1 Wave", 43, DESCRIPTOR_CHOICE, 0, 3, 0, 32, 64, lfo_waves },
+    [PARAMETER_LFO1_INITIAL_LEVEL] = { "LFO 1 Initial Level", 44, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO1_DELAY] = { "LFO 1 Delay", 45, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO1_FINAL_LEVEL] = { "LFO 1 Final Level", 46, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO1_MOD_SRC] = { "LFO 1 Mod", 47, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+
+    /* LFO 2 */
+    [PARAMETER_LFO2_FREQUENCY] = { "LFO 2 Frequency", 48, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO2_RESET] = { "LFO 2 Reset", 49, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL },
+    [PARAMETER_LFO2_HUMAN] = { "LFO 2 Human", 50, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL },
+    [PARAMETER_LFO2_WAVE] = { "LFO 2 Wave", 51, DESCRIPTOR_CHOICE, 0, 3, 0, 32, 64, lfo_waves },
+    [PARAMETER_LFO2_INITIAL_LEVEL] = { "LFO 2 Initial Level", 52, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO2_DELAY] = { "LFO 2 Delay", 53, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO2_FINAL_LEVEL] = { "LFO 2 Final Level", 54, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO2_MOD_SRC] = { "LFO 2 Mod", 55, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+
+    /* LFO 3 */
+    [PARAMETER_LFO3_FREQUENCY] = { "LFO 3 Frequency", 56, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO3_RESET] = { "LFO 3 Reset", 57, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL },
+    [PARAMETER_LFO3_HUMAN] = { "LFO 3 Human", 58, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL },
+    [PARAMETER_LFO3_WAVE] = { "LFO 3 Wave", 59, DESCRIPTOR_CHOICE, 0, 3, 0, 32, 64, lfo_waves },
+    [PARAMETER_LFO3_INITIAL_LEVEL] = { "LFO 3 Initial Level", 60, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO3_DELAY] = { "LFO 3 Delay", 61, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO3_FINAL_LEVEL] = { "LFO 3 Final Level", 62, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_LFO3_MOD_SRC] = { "LFO 3 Mod", 63, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+
+    /* Oscillator 1 */
+    [PARAMETER_OSC1_OCTAVE] = { "Oscillator 1 Octave", 64, DESCRIPTOR_SIGNED, -3, 5, 4, 14, 16, NULL },
+    [PARAMETER_OSC1_SEMITONE] = { "Oscillator 1 Semitone", 65, DESCRIPTOR_UNSIGNED, 0, 11, 0, 11, 11, NULL },
+    [PARAMETER_OSC1_FINE] = { "Oscillator 1 Fine", 66, DESCRIPTOR_UNSIGNED, 0, 31, 0, 4, 4, NULL },
+    [PARAMETER_OSC1_WAVE] = { "Oscillator 1 Wave", 67, DESCRIPTOR_CHOICE, 0, 74, 0, 1, 96, oscillator_waves },
+    [PARAMETER_OSC1_MOD1_SRC] = { "Oscillator 1 Mod 1", 68, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_OSC1_MOD1_DEPTH] = { "Oscillator 1 Mod 1 Depth", 69, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_OSC1_MOD2_SRC] = { "Oscillator 1 Mod 2", 70, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_OSC1_MOD2_DEPTH] = { "Oscillator 1 Mod 2 Depth", 71, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+
+    /* Oscillator 2 */
+    [PARAMETER_OSC2_OCTAVE] = { "Oscillator 2 Octave", 72, DESCRIPTOR_SIGNED, -3, 5, 4, 14, 16, NULL },
+    [PARAMETER_OSC2_SEMITONE] = { "Oscillator 2 Semitone", 73, DESCRIPTOR_UNSIGNED, 0, 11, 0, 11, 11, NULL },
+    [PARAMETER_OSC2_FINE] = { "Oscillator 2 Fine", 74, DESCRIPTOR_UNSIGNED, 0, 31, 0, 4, 4, NULL },
+    [PARAMETER_OSC2_WAVE] = { "Oscillator 2 Wave", 75, DESCRIPTOR_CHOICE, 0, 74, 0, 1, 96, oscillator_waves },
+    [PARAMETER_OSC2_MOD1_SRC] = { "Oscillator 2 Mod 1", 76, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_OSC2_MOD1_DEPTH] = { "Oscillator 2 Mod 1 Depth", 77, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_OSC2_MOD2_SRC] = { "Oscillator 2 Mod 2", 78, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_OSC2_MOD2_DEPTH] = { "Oscillator 2 Mod 2 Depth", 79, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+
+    /* Oscillator 3 */
+    [PARAMETER_OSC3_OCTAVE] = { "Oscillator 3 Octave", 80, DESCRIPTOR_SIGNED, -3, 5, 4, 14, 16, NULL },
+    [PARAMETER_OSC3_SEMITONE] = { "Oscillator 3 Semitone", 81, DESCRIPTOR_UNSIGNED, 0, 11, 0, 11, 11, NULL },
+    [PARAMETER_OSC3_FINE] = { "Oscillator 3 Fine", 82, DESCRIPTOR_UNSIGNED, 0, 31, 0, 4, 4, NULL },
+    [PARAMETER_OSC3_WAVE] = { "Oscillator 3 Wave", 83, DESCRIPTOR_CHOICE, 0, 74, 0, 1, 96, oscillator_waves },
+    [PARAMETER_OSC3_MOD1_SRC] = { "Oscillator 3 Mod 1", 84, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_OSC3_MOD1_DEPTH] = { "Oscillator 3 Mod 1 Depth", 85, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_OSC3_MOD2_SRC] = { "Oscillator 3 Mod 2", 86, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_OSC3_MOD2_DEPTH] = { "Oscillator 3 Mod 2 Depth", 87, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+
+    /* DCA 1 */
+    [PARAMETER_DCA1_LEVEL] = { "DCA 1 Level", 88, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_DCA1_OUTPUT] = { "DCA 1 Output", 89, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 64, NULL },
+    [PARAMETER_DCA1_MOD1_SRC] = { "DCA 1 Mod 1", 90, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_DCA1_MOD1_DEPTH] = { "DCA 1 Mod 1 Depth", 91, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_DCA1_MOD2_SRC] = { "DCA 1 Mod 2", 92, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_DCA1_MOD2_DEPTH] = { "DCA 1 Mod 2 Depth", 93, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+
+    /* DCA 2 */
+    [PARAMETER_DCA2_LEVEL] = { "DCA 2 Level", 94, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_DCA2_OUTPUT] = { "DCA 2 Output", 95, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 64, NULL },
+    [PARAMETER_DCA2_MOD1_SRC] = { "DCA 2 Mod 1", 96, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_DCA2_MOD1_DEPTH] = { "DCA 2 Mod 1 Depth", 97, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_DCA2_MOD2_SRC] = { "DCA 2 Mod 2", 98, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_DCA2_MOD2_DEPTH] = { "DCA 2 Mod 2 Depth", 99, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+
+    /* DCA 3 */
+    [PARAMETER_DCA3_LEVEL] = { "DCA 3 Level", 100, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_DCA3_OUTPUT] = { "DCA 3 Output", 101, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 64, NULL },
+    [PARAMETER_DCA3_MOD1_SRC] = { "DCA 3 Mod 1", 102, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_DCA3_MOD1_DEPTH] = { "DCA 3 Mod 1 Depth", 103, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_DCA3_MOD2_SRC] = { "DCA 3 Mod 2", 104, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_DCA3_MOD2_DEPTH] = { "DCA 3 Mod 2 Depth", 105, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+
+    /* DCA 4 */
+    [PARAMETER_DCA4_ENV4_DEPTH] = { "DCA 4 Env 4 Depth", 106, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_DCA4_PAN] = { "DCA 4 Pan", 107, DESCRIPTOR_UNSIGNED, 0, 15, 0, 8, 8, NULL },
+    [PARAMETER_DCA4_MOD_SRC] = { "DCA 4 Pan Mod", 108, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_DCA4_MOD_DEPTH] = { "DCA 4 Pan Mod Depth", 109, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+
+    /* Filter */
+    [PARAMETER_FILTER_FREQUENCY] = { "Filter Frequency", 110, DESCRIPTOR_UNSIGNED, 0, 127, 0, 1, 1, NULL },
+    [PARAMETER_FILTER_RESONANCE] = { "Filter Resonance", 111, DESCRIPTOR_UNSIGNED, 0, 31, 0, 4, 4, NULL },
+    [PARAMETER_FILTER_KEYBOARD_TRACKING] = { "Filter Keyboard Tracking", 112, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_FILTER_MOD1_SRC] = { "Filter Mod 1", 113, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_FILTER_MOD1_DEPTH] = { "Filter Mod 1 Depth", 114, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+    [PARAMETER_FILTER_MOD2_SRC] = { "Filter Mod 2", 115, DESCRIPTOR_CHOICE, 0, 15, 0, 8, 32, mod_srcs },
+    [PARAMETER_FILTER_MOD2_DEPTH] = { "Filter Mod 2 Depth", 116, DESCRIPTOR_SIGNED, -63, 63, 64, 1, 1, NULL },
+
+    /* Modes */
+    [PARAMETER_AMPLITUDE_MODULATION] = { "Amplitude Modulation", 117, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 64, NULL },
+    [PARAMETER_GLIDE] = { "Glide", 118, DESCRIPTOR_UNSIGNED, 0, 63, 0, 2, 2, NULL },
+    [PARAMETER_MONO] = { "Mono", 119, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL },
+    [PARAMETER_SYNC] = { "Sync", 120, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 64, NULL },
+    [PARAMETER_VOICE_RESTART] = { "Voice Restart", 121, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL },
+    [PARAMETER_ENVELOPE_RESTART] = { "Envelope Restart", 122, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL },
+    [PARAMETER_OSCILLATOR_RESTART] = { "Oscillator Restart", 123, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL },
+    [PARAMETER_ENVELOPE_FULL_CYCLE] = { "Envelope Full Cycle", 124, DESCRIPTOR_SWITCH, 0, 1, 0, 64, 32, NULL }
+};
+
+static void initialise_bounds(void);
+
+/**
+   \brief Converts the value of a parameter, as held in a patch, to the value
+   its widget shows.
+
+   \param parameter - the patch parameter.
+   \param value - the value held in the patch.
+   \return the value shown.
+ */
+gint
+parameters_decode(gint parameter, guchar value)
+{
+    return parameter_descriptors[parameter].kind == DESCRIPTOR_SIGNED ? (gint8) value : value;
+}
+
+/**
+   \brief Checks whether the value of a parameter, as held in a patch, is in
+   the parameter's range.
+
+   \param parameter - the patch parameter.
+   \param value - the value held in the patch.
+   \return whether the value is in range.
+ */
+gboolean
+parameters_valid(gint parameter, guchar value)
+{
+    const ParameterDescriptor *descriptor;
+    gint v;
+
+    descriptor = &parameter_descriptors[parameter];
+
+    v = parameters_decode(parameter, value);
+
+    return v >= descriptor->minimum && v <= descriptor->maximum;
+}
+
+/**
+   \brief Brings a value, as shown by a parameter's widget, into the
+   parameter's range and converts it to the value held in a patch.
+
+   \param parameter - the patch parameter.
+   \param value - the value as shown.
+   \return the value to hold in the patch.
+ */
+guchar
+parameters_clamp(gint parameter, gint value)
+{
+    const ParameterDescriptor *descriptor;
+
+    descriptor = &parameter_descriptors[parameter];
+
+    return (guchar) CLAMP(value, descriptor->minimum, descriptor->maximum);
+}
+
+/**
+   \brief Converts the value of a parameter, as held in a patch, to the value
+   sent in the data entry of its NRPN. Values out of range are clamped, so
+   the result always fits in seven bits.
+
+   \param parameter - the patch parameter.
+   \param value - the value held in the patch.
+   \return the value to transmit.
+ */
+gint
+parameters_encode(gint parameter, guchar value)
+{
+    const ParameterDescriptor *descriptor;
+    gint v;
+
+    descriptor = &parameter_descriptors[parameter];
+
+    v = CLAMP(parameters_decode(parameter, value), descriptor->minimum, descriptor->maximum);
+
+    return (v + descriptor->offset) * descriptor->multiplier;
+}
+
+/**
+   \brief Validates every parameter of a patch and converts them to the
+   values sent in the data entries of their NRPNs, as parameters_encode()
+   does for one.
+
+   \param parameters - the parameters of the patch.
+   \param data - the values to transmit to fill in, PARAMETER_COUNT long.
+   \return the number of parameters that were out of range.
+ */
+gint
+parameters_encode_all(const guchar *parameters, guchar *data)
+{
+    const ParameterDescriptor *descriptor;
+    gint i, v, invalid;
+
+    invalid = 0;
+
+    for (i = 0; i < PARAMETER_COUNT; ++i) {
+        descriptor = &parameter_descriptors[i];
+
+        v = descriptor->kind == DESCRIPTOR_SIGNED ? (gint8) parameters[i] : parameters[i];
+
+        invalid += v < descriptor->minimum || v > descriptor->maximum;
+
+        v = CLAMP(v, descriptor->minimum, descriptor->maximum);
+
+        data[i] = (guchar) ((v + descriptor->offset) * descriptor->multiplier);
+    }
+
+    return invalid;
+}
+
+/**
+   \brief Finds the parameters of a patch that are out of range. The loop is
+   kept free of branches so the compiler can turn it into packed byte
+   comparisons, making it cheap enough to run over a whole library.
+
+   \param parameters - the parameters of the patch.
+   \param invalid - set to 1 for each parameter out of range and 0 for the
+   others, PARAMETER_COUNT long.
+   \return the number of parameters out of range.
+ */
+gint
+parameters_check(const guchar *parameters, guchar *invalid)
+{
+    gint i, count;
+    guchar v;
+
+    initialise_bounds();
+
+    count = 0;
+
+    for (i = 0; i < PARAMETER_COUNT; ++i) {
+        v = parameters[i] ^ biases[i];
+        invalid[i] = (v < lowers[i]) | (v > uppers[i]);
+        count += invalid[i];
+    }
+
+    return count;
+}
+
+/**
+   \brief Brings every parameter of a patch into its range, leaving those
+   already in range as they are.
+
+   \param parameters - the parameters of the patch.
+ */
+void
+parameters_clamp_all(guchar *parameters)
+{
+    gint i;
+    guchar v;
+
+    initialise_bounds();
+
+    for (i = 0; i < PARAMETER_COUNT; ++i) {
+        v = parameters[i] ^ biases[i];
+        v = MAX(v, lowers[i]);
+        v = MIN(v, uppers[i]);
+        parameters[i] = v ^ biases[i];
+    }
+}
+
+static void
+initialise_bounds(void)
+{
+    static gsize initialised = 0;
+    gint i;
+
+    if (g_once_init_enter(&initialised)) {
+        for (i = 0; i < PARAMETER_COUNT; ++i) {
+            biases[i] = parameter_descriptors[i].kind == DESCRIPTOR_SIGNED ? 0x80 : 0x00;
+            lowers[i] = (guchar) parameter_descriptors[i].minimum ^ biases[i];
+            uppers[i] = (guchar) parameter_descriptors[i].maximum ^ biases[i];
+        }
+
+        g_once_init_leave(&initialised, 1);
+    }
+}
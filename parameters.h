@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef PARAMETERS_H
+#define PARAMETERS_H
+
+typedef enum {
+    /* sliders */
+    DESCRIPTOR_UNSIGNED,
+    /* sliders with negative values, held in a patch as a signed byte */
+    DESCRIPTOR_SIGNED,
+    /* waves and mod sources, held in a patch as the index of their label */
+    DESCRIPTOR_CHOICE,
+    /* check buttons, held in a patch as 0 or 1 */
+    DESCRIPTOR_SWITCH
+} DescriptorKind;
+
+/*
+ * Every kind of parameter is sent in the data entry of its NRPN as
+ * (value + offset) * multiplier, which always fits in seven bits, so no
+ * parameter needs the data entry LSB.
+ */
+typedef struct {
+    const gchar *name;
+    guchar nrpn;
+    DescriptorKind kind;
+    gint minimum;
+    gint maximum;
+    gint offset;
+    gint multiplier;
+    /* how much a change is heard, per step of a slider or for any change of choice */
+    guint weight;
+    /* the labels of a choice, maximum + 1 long */
+    const gchar *const *labels;
+} ParameterDescriptor;
+
+extern const ParameterDescriptor parameter_descriptors[PARAMETER_COUNT];
+
+gint parameters_decode(gint, guchar);
+gboolean parameters_valid(gint, guchar);
+guchar parameters_clamp(gint, gint);
+gint parameters_encode(gint, guchar);
+gint parameters_encode_all(const guchar *, guchar *);
+gint parameters_check(const guchar *, guchar *);
+void parameters_clamp_all(guchar *);
+
+#endif /* !PARAMETERS_H */
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "patch.h"
+
+/* A patch in a slab, which holds the next free patch when not in use */
+typedef union PatchSlot {
+    Patch patch;
+    union PatchSlot *next;
+} PatchSlot;
+
+/* Patches may be read by the batch rendering threads */
+static GMutex slab_mutex;
+
+static PatchSlot *slab = NULL;
+static guint slab_used = 0;
+static PatchSlot *free_slots = NULL;
+
+static gchar *set_string(gchar *, gchar *, gsize, const gchar *, gssize);
+
+/**
+   \brief Creates an empty patch. Patches are handed out from slabs of
+   PATCH_SLAB_SIZE, so a large library occupies a few contiguous blocks
+   rather than a separate allocation per patch, name and type. The memory
+   of freed patches is reused for new patches.
+
+   \return the patch.
+ */
+Patch *
+patch_new(void)
+{
+    PatchSlot *slot;
+
+    g_mutex_lock(&slab_mutex);
+
+    if (free_slots) {
+        slot = free_slots;
+        free_slots = slot->next;
+    } else {
+        if (!slab || slab_used == PATCH_SLAB_SIZE) {
+            slab = g_new(PatchSlot, PATCH_SLAB_SIZE);
+            slab_used = 0;
+        }
+        slot = &slab[slab_used++];
+    }
+
+    g_mutex_unlock(&slab_mutex);
+
+    memset(&slot->patch, 0, sizeof(Patch));
+    slot->patch.name = slot->patch.name_buffer;
+    slot->patch.type = slot->patch.type_buffer;
+
+    return &slot->patch;
+}
+
+/**
+   \brief Frees a patch created with patch_new().
+
+   \param patch - the patch to free.
+ */
+void
+patch_free(Patch *patch)
+{
+    PatchSlot *slot = (PatchSlot *) patch;
+
+    if (patch->name != patch->name_buffer) {
+        g_free(patch->name);
+    }
+    if (patch->type != patch->type_buffer) {
+        g_free(patch->type);
+    }
+
+    g_mutex_lock(&slab_mutex);
+
+    slot->next = free_slots;
+    free_slots = slot;
+
+    g_mutex_unlock(&slab_mutex);
+}
+
+/**
+   \brief Sets the name of a patch. A name too long to be held in the patch
+   is kept in full in an allocation of its own.
+
+   \param patch - the patch.
+   \param name - the name.
+   \param length - the length of the name, or -1 if it is nul terminated.
+ */
+void
+patch_set_name(Patch *patch, const gchar *name, gssize length)
+{
+    patch->name = set_string(patch->name, patch->name_buffer, sizeof(patch->name_buffer), name, length);
+}
+
+/**
+   \brief Sets the type of a patch. A type too long to be held in the patch
+   is kept in full in an allocation of its own.
+
+   \param patch - the patch.
+   \param type - the type.
+   \param length - the length of the type, or -1 if it is nul terminated.
+ */
+void
+patch_set_type(Patch *patch, const gchar *type, gssize length)
+{
+    patch->type = set_string(patch->type, patch->type_buffer, sizeof(patch->type_buffer), type, length);
+}
+
+/**
+   \brief Sets the file a patch is saved in. File names are interned, so
+   patches from the same file share one copy of the name, and can be
+   compared by pointer.
+
+   \param patch - the patch.
+   \param filename - the name of the file.
+ */
+void
+patch_set_filename(Patch *patch, const gchar *filename)
+{
+    patch->filename = g_intern_string(filename);
+}
+
+/*
+ * Copies a string into the buffer in a patch if it fits, or a copy of its
+ * own if it doesn't, freeing the copy the patch held before.
+ */
+static gchar *
+set_string(gchar *current, gchar *buffer, gsize size, const gchar *src, gssize length)
+{
+    gchar *string;
+    gsize n;
+
+    n = length < 0 ? strlen(src) : (gsize) length;
+
+    if (n < size) {
+        memmove(buffer, src, n);
+        buffer[n] = '\0';
+        string = buffer;
+    } else {
+        string = g_strndup(src, n);
+    }
+
+    if (current != buffer) {
+        g_free(current);
+    }
+
+    return string;
+}
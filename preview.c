@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <alsa/asoundlib.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "envgen.h"
+#include "lfogen.h"
+#include "modmatrix.h"
+#include "vcf.h"
+#include "synth.h"
+#include "preview.h"
+
+/* Frames rendered and written to the device at a time */
+#define PREVIEW_FRAMES 256
+
+/* Latency asked of the device, in microseconds */
+#define PREVIEW_LATENCY 20000
+
+/* Number of note events that can wait for the audio thread */
+#define PREVIEW_EVENT_COUNT 64
+
+/* Set in the shared snapshot index when it holds parameters not yet played */
+#define PREVIEW_FRESH 4
+
+typedef struct {
+    gint note;
+    gint velocity;
+} PreviewEvent;
+
+static snd_pcm_t *pcm = NULL;
+static GThread *thread = NULL;
+static gint running = 0;
+
+/*
+ * Snapshots of the patch parameters, passed from the GTK thread to the
+ * audio thread through a triple buffer. Each thread owns one snapshot and
+ * swaps it with the shared one, so neither ever waits for the other.
+ */
+static guchar snapshots[3][PARAMETER_COUNT];
+static gint back_snapshot = 0;
+static gint shared_snapshot = 1;
+static gint front_snapshot = 2;
+
+/* Note events, written by the GTK thread and read by the audio thread */
+static PreviewEvent events[PREVIEW_EVENT_COUNT];
+static gint event_head = 0;
+static gint event_tail = 0;
+
+static gpointer audio_thread(gpointer);
+static gint exchange_snapshot(gint);
+static void push_event(gint, gint);
+static gboolean pop_event(PreviewEvent *);
+
+/**
+   \brief Opens an ALSA device and starts playing the preview through it.
+
+   \param device - the name of the ALSA device, such as default or null.
+   \param error - set if the device can't be opened.
+   \return whether the preview was started.
+ */
+gboolean
+preview_start(const gchar *device, GError **error)
+{
+    Synth *synth;
+    gint status;
+
+    if (preview_is_running()) {
+        return TRUE;
+    }
+
+    /* clean up after a thread that stopped on a device error */
+    preview_stop();
+
+    if ((status = snd_pcm_open(&pcm, device, SND_PCM_STREAM_PLAYBACK, 0)) < 0) {
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(-status), "%s: %s", device, snd_strerror(status));
+        pcm = NULL;
+        return FALSE;
+    }
+
+    if ((status = snd_pcm_set_params(pcm, SND_PCM_FORMAT_S16, SND_PCM_ACCESS_RW_INTERLEAVED, 2, SYNTH_SAMPLE_RATE, 1, PREVIEW_LATENCY)) < 0) {
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(-status), "%s: %s", device, snd_strerror(status));
+        snd_pcm_close(pcm);
+        pcm = NULL;
+        return FALSE;
+    }
+
+    synth = synth_new(snapshots[front_snapshot], SYNTH_SAMPLE_RATE);
+
+    g_atomic_int_set(&running, 1);
+
+    if (!(thread = g_thread_try_new("preview", audio_thread, synth, error))) {
+        g_atomic_int_set(&running, 0);
+        synth_free(synth);
+        snd_pcm_close(pcm);
+        pcm = NULL;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+   \brief Stops playing the preview and closes the ALSA device. This also
+   cleans up after the audio thread if it stopped on a device error.
+ */
+void
+preview_stop(void)
+{
+    if (!thread) {
+        return;
+    }
+
+    g_atomic_int_set(&running, 0);
+    g_thread_join(thread);
+    thread = NULL;
+
+    snd_pcm_close(pcm);
+    pcm = NULL;
+}
+
+/**
+   \brief Returns whether the preview is playing, which it isn't once the
+   audio thread has stopped on a device error.
+
+   \return whether the preview is playing.
+ */
+gboolean
+preview_is_running(void)
+{
+    return g_atomic_int_get(&running) != 0;
+}
+
+/**
+   \brief Passes the parameters of the patch being edited to the preview,
+   which plays them from its next block. Only the latest parameters are
+   kept if the audio thread hasn't taken the last ones.
+
+   \param parameters - the parameters of the patch, which are copied.
+ */
+void
+preview_set_parameters(const guchar *parameters)
+{
+    if (!preview_is_running()) {
+        return;
+    }
+
+    /* build any new waves here rather than in the audio thread */
+    synth_prepare(parameters);
+
+    memcpy(snapshots[back_snapshot], parameters, PARAMETER_COUNT);
+    back_snapshot = exchange_snapshot(back_snapshot | PREVIEW_FRESH) & ~PREVIEW_FRESH;
+}
+
+/**
+   \brief Starts playing a note with the preview.
+
+   \param note - the MIDI note number.
+   \param velocity - the note on velocity.
+ */
+void
+preview_note_on(gint note, gint velocity)
+{
+    push_event(note, MAX(velocity, 1));
+}
+
+/**
+   \brief Releases a note played with the preview.
+
+   \param note - the MIDI note number.
+ */
+void
+preview_note_off(gint note)
+{
+    push_event(note, 0);
+}
+
+/*
+ * Renders the preview and writes it to the device until the preview is
+ * stopped. Blocking in the device is the only waiting the thread does.
+ */
+static gpointer
+audio_thread(gpointer data)
+{
+    Synth *synth = data;
+    PreviewEvent event;
+    gfloat left[PREVIEW_FRAMES], right[PREVIEW_FRAMES];
+    gint16 buffer[PREVIEW_FRAMES * 2];
+    snd_pcm_sframes_t written;
+    gint i, offset;
+
+    while (g_atomic_int_get(&running)) {
+        if (g_atomic_int_get(&shared_snapshot) & PREVIEW_FRESH) {
+            front_snapshot = exchange_snapshot(front_snapshot) & ~PREVIEW_FRESH;
+            synth_set_parameters(synth, snapshots[front_snapshot]);
+        }
+
+        while (pop_event(&event)) {
+            if (event.velocity) {
+                synth_note_on(synth, event.note, event.velocity);
+            } else {
+                synth_note_off(synth, event.note);
+            }
+        }
+
+        memset(left, 0, sizeof(left));
+        memset(right, 0, sizeof(right));
+
+        synth_process(synth, left, right, PREVIEW_FRAMES);
+
+        for (i = 0; i < PREVIEW_FRAMES; ++i) {
+            buffer[i * 2] = CLAMP(left[i], -1.0f, 1.0f) * 32767.0f;
+            buffer[i * 2 + 1] = CLAMP(right[i], -1.0f, 1.0f) * 32767.0f;
+        }
+
+        for (offset = 0; offset < PREVIEW_FRAMES && g_atomic_int_get(&running); offset += written) {
+            if ((written = snd_pcm_writei(pcm, buffer + offset * 2, PREVIEW_FRAMES - offset)) < 0) {
+                if ((written = snd_pcm_recover(pcm, written, 1)) < 0) {
+                    g_printerr("Preview stopped: %s\n", snd_strerror(written));
+                    g_atomic_int_set(&running, 0);
+                }
+                written = 0;
+            }
+        }
+    }
+
+    synth_free(synth);
+
+    return NULL;
+}
+
+/*
+ * Swaps a snapshot with the shared snapshot, returning the shared one.
+ */
+static gint
+exchange_snapshot(gint snapshot)
+{
+    gint shared;
+
+    do {
+        shared = g_atomic_int_get(&shared_snapshot);
+    } while (!g_atomic_int_compare_and_exchange(&shared_snapshot, shared, snapshot));
+
+    return shared;
+}
+
+/*
+ * Queues a note event for the audio thread, dropping it if the queue is
+ * full.
+ */
+static void
+push_event(gint note, gint velocity)
+{
+    gint head, next;
+
+    if (!preview_is_running()) {
+        return;
+    }
+
+    head = g_atomic_int_get(&event_head);
+    next = (head + 1) % PREVIEW_EVENT_COUNT;
+
+    if (next == g_atomic_int_get(&event_tail)) {
+        return;
+    }
+
+    events[head].note = note;
+    events[head].velocity = velocity;
+
+    g_atomic_int_set(&event_head, next);
+}
+
+static gboolean
+pop_event(PreviewEvent *event)
+{
+    gint tail;
+
+    tail = g_atomic_int_get(&event_tail);
+
+    if (tail == g_atomic_int_get(&event_head)) {
+        return FALSE;
+    }
+
+    *event = events[tail];
+
+    g_atomic_int_set(&event_tail, (tail + 1) % PREVIEW_EVENT_COUNT);
+
+    return TRUE;
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "parameters.h"
+#include "similar.h"
+
+/* Number of patches room is first made for */
+#define SIMILAR_INITIAL_CAPACITY 256
+
+/* Weighted slider values are grouped in steps of 1 << SIMILAR_COARSE_SHIFT */
+#define SIMILAR_COARSE_SHIFT 3
+
+static gboolean is_choice(gint);
+static guchar encode(gint, guchar);
+static void add_differences(guint32 *, const guchar *, guchar, guint, guint);
+static void add_mismatches(guint32 *, const guchar *, guchar, guint, guint);
+
+/**
+   \brief Creates an empty index of patch parameters.
+
+   \return the index.
+ */
+SimilarIndex *
+similar_index_new(void)
+{
+    SimilarIndex *index;
+
+    index = g_new0(SimilarIndex, 1);
+
+    return index;
+}
+
+/**
+   \brief Frees an index of patch parameters.
+
+   \param index - the index to free.
+ */
+void
+similar_index_free(SimilarIndex *index)
+{
+    g_free(index->columns);
+    g_free(index->distances);
+    g_free(index->items);
+    g_free(index);
+}
+
+/**
+   \brief Adds the parameters of a patch to an index.
+
+   \param index - the index.
+   \param parameters - the parameters of the patch.
+   \param item - the data returned with the patch, such as the patch itself.
+ */
+void
+similar_index_add(SimilarIndex *index, const guchar *parameters, gpointer item)
+{
+    guchar *columns;
+    guint capacity;
+    gint i;
+
+    if (index->count == index->capacity) {
+        capacity = index->capacity ? index->capacity * 2 : SIMILAR_INITIAL_CAPACITY;
+
+        /* each parameter is a column of values, one per patch */
+        columns = g_new(guchar, (gsize) capacity * PARAMETER_COUNT);
+        for (i = 0; i < PARAMETER_COUNT; ++i) {
+            if (index->count) {
+                memcpy(columns + (gsize) i * capacity, index->columns + (gsize) i * index->capacity, index->count);
+            }
+        }
+
+        g_free(index->columns);
+        index->columns = columns;
+        index->distances = g_renew(guint32, index->distances, capacity);
+        index->items = g_renew(gpointer, index->items, capacity);
+        index->capacity = capacity;
+    }
+
+    for (i = 0; i < PARAMETER_COUNT; ++i) {
+        index->columns[(gsize) i * index->capacity + index->count] = encode(i, parameters[i]);
+    }
+
+    index->items[index->count++] = item;
+}
+
+/**
+   \brief Finds the patches in an index with the closest parameters to a
+   patch.
+
+   \param index - the index.
+   \param parameters - the parameters of the patch to find neighbours of.
+   \param matches - the closest matches, closest first.
+   \param count - the greatest number of matches to find.
+   \return the number of matches found.
+ */
+gint
+similar_index_search(SimilarIndex *index, const guchar *parameters, SimilarMatch *matches, gint count)
+{
+    const guchar *column;
+    guint32 distance;
+    guint i;
+    gint j, found;
+
+    if (count < 1 || index->count < 1) {
+        return 0;
+    }
+
+    memset(index->distances, 0, index->count * sizeof(guint32));
+
+    /* sweep down each column, so every pass is a run of bytes */
+    for (j = 0; j < PARAMETER_COUNT; ++j) {
+        column = index->columns + (gsize) j * index->capacity;
+
+        if (is_choice(j)) {
+            add_mismatches(index->distances, column, encode(j, parameters[j]), parameter_descriptors[j].weight, index->count);
+        } else {
+            add_differences(index->distances, column, encode(j, parameters[j]), parameter_descriptors[j].weight, index->count);
+        }
+    }
+
+    for (found = 0, i = 0; i < index->count; ++i) {
+        distance = index->distances[i];
+
+        if (found == count && distance >= matches[found - 1].distance) {
+            continue;
+        }
+
+        /* insert into the sorted matches, dropping the furthest if they're full */
+        j = found < count ? found++ : found - 1;
+        for (; j > 0 && matches[j - 1].distance > distance; --j) {
+            matches[j] = matches[j - 1];
+        }
+        matches[j].index = i;
+        matches[j].distance = distance;
+    }
+
+    return found;
+}
+
+/**
+   \brief Reduces the parameters of a patch to a coarser form, in which the
+   sliders are grouped into about 16 steps each and waves, mod sources and
+   switches are kept as they are. Patches that sound almost the same share
+   a coarse form, unless a slider falls either side of a step.
+
+   \param parameters - the parameters of the patch.
+   \param coarse - the coarse form to fill in, PARAMETER_COUNT long.
+ */
+void
+similar_coarsen(const guchar *parameters, guchar *coarse)
+{
+    gint i;
+
+    for (i = 0; i < PARAMETER_COUNT; ++i) {
+        if (is_choice(i)) {
+            coarse[i] = parameters[i];
+        } else {
+            /* the weighted range is under 256 steps, so wrapping keeps them apart */
+            coarse[i] = (guchar) ((encode(i, parameters[i]) * parameter_descriptors[i].weight) >> SIMILAR_COARSE_SHIFT);
+        }
+    }
+}
+
+/*
+ * Returns whether a parameter is a wave, mod source or switch, whose values
+ * only count as the same or different.
+ */
+static gboolean
+is_choice(gint parameter)
+{
+    return parameter_descriptors[parameter].kind == DESCRIPTOR_CHOICE || parameter_descriptors[parameter].kind == DESCRIPTOR_SWITCH;
+}
+
+/*
+ * Converts a parameter value to the form kept in the columns, flipping the
+ * sign bit of signed values so their differences can be taken as unsigned.
+ */
+static guchar
+encode(gint parameter, guchar value)
+{
+    return parameter_descriptors[parameter].kind == DESCRIPTOR_SIGNED ? value ^ 0x80 : value;
+}
+
+/*
+ * Adds the weighted absolute differences between a column and a value to the
+ * distances. The loop is kept free of branches so the compiler can turn it
+ * into packed byte arithmetic.
+ */
+static void
+add_differences(guint32 *distances, const guchar *column, guchar value, guint weight, guint count)
+{
+    guint i;
+
+    for (i = 0; i < count; ++i) {
+        distances[i] += ABS((gint) column[i] - value) * weight;
+    }
+}
+
+/*
+ * Adds a penalty to the distances for each value in a column that differs
+ * from a value.
+ */
+static void
+add_mismatches(guint32 *distances, const guchar *column, guchar value, guint penalty, guint count)
+{
+    guint i;
+
+    for (i = 0; i < count; ++i) {
+        distances[i] += (column[i] != value) * penalty;
+    }
+}
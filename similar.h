@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef SIMILAR_H
+#define SIMILAR_H
+
+/* Number of patches listed by the similar option and menu item */
+#define SIMILAR_COUNT 10
+
+typedef struct {
+    guint index;
+    guint distance;
+} SimilarMatch;
+
+typedef struct {
+    guint count;
+    guint capacity;
+    guchar *columns;
+    guint32 *distances;
+    gpointer *items;
+} SimilarIndex;
+
+SimilarIndex *similar_index_new(void);
+void similar_index_free(SimilarIndex *);
+void similar_index_add(SimilarIndex *, const guchar *, gpointer);
+gint similar_index_search(SimilarIndex *, const guchar *, SimilarMatch *, gint);
+void similar_coarsen(const guchar *, guchar *);
+
+#endif /* !SIMILAR_H */
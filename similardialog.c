@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "dialog.h"
+#include "similar.h"
+#include "similardialog.h"
+
+/*
+ * Lists the patches in the library with the closest parameters to a patch,
+ * returning the one chosen from the list, or NULL if none was chosen.
+ */
+Patch *
+run_similar_dialog(GtkWindow *parent, GtkTreeModel *patches, Patch *patch)
+{
+    GtkWidget *dialog, *scrolled_window, *tree_view;
+    GtkListStore *store;
+    GtkTreeSelection *selection;
+    GtkTreeViewColumn *column;
+    GtkCellRenderer *renderer;
+    GtkTreeModel *model;
+    GtkTreeIter iter;
+    SimilarIndex *index;
+    SimilarMatch matches[SIMILAR_COUNT + 1];
+    Patch *match, *selected;
+    gboolean valid;
+    gint i, n, listed;
+
+    /* index the library afresh, so edits since the last search are seen */
+    index = similar_index_new();
+
+    valid = gtk_tree_model_get_iter_first(patches, &iter);
+
+    while (valid) {
+        gtk_tree_model_get(patches, &iter, DATA_COL, &match, -1);
+        similar_index_add(index, match->parameters, match);
+        valid = gtk_tree_model_iter_next(patches, &iter);
+    }
+
+    /* one extra, as the patch is its own closest match */
+    n = similar_index_search(index, patch->parameters, matches, SIMILAR_COUNT + 1);
+
+    store = gtk_list_store_new(NCOLS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_POINTER);
+
+    for (listed = 0, i = 0; i < n && listed < SIMILAR_COUNT; ++i) {
+        match = index->items[matches[i].index];
+
+        if (match != patch) {
+            gtk_list_store_append(store, &iter);
+            gtk_list_store_set(store, &iter,
+                NAME_COL, match->name,
+                TYPE_COL, match->type,
+                DATA_COL, match,
+                -1);
+            ++listed;
+        }
+    }
+
+    similar_index_free(index);
+
+    dialog = gtk_dialog_new_with_buttons("Similar Patches",
+        parent,
+        GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+        "_Select", GTK_RESPONSE_ACCEPT,
+        "_Close", GTK_RESPONSE_CLOSE,
+        NULL);
+    gtk_window_set_default_size(GTK_WINDOW(dialog), -1, 300);
+
+    scrolled_window = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_shadow_type(GTK_SCROLLED_WINDOW(scrolled_window), GTK_SHADOW_ETCHED_IN);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled_window), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_box_pack_start(GTK_BOX(gtk_dialog_get_content_area(GTK_DIALOG(dialog))), scrolled_window, TRUE, TRUE, 0);
+
+    tree_view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(store));
+    g_object_unref(store);
+    g_signal_connect(G_OBJECT(tree_view), "row-activated", G_CALLBACK(activate_row_callback), dialog);
+    gtk_container_add(GTK_CONTAINER(scrolled_window), tree_view);
+
+    renderer = gtk_cell_renderer_text_new();
+    column = gtk_tree_view_column_new_with_attributes("Name", renderer, "text", NAME_COL, NULL);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view), column);
+
+    renderer = gtk_cell_renderer_text_new();
+    column = gtk_tree_view_column_new_with_attributes("Type", renderer, "text", TYPE_COL, NULL);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(tree_view), column);
+
+    gtk_widget_show_all(scrolled_window);
+
+    selected = NULL;
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(tree_view));
+
+        if (gtk_tree_selection_get_selected(selection, &model, &iter)) {
+            gtk_tree_model_get(model, &iter, DATA_COL, &selected, -1);
+        }
+    }
+
+    gtk_widget_destroy(dialog);
+
+    return selected;
+}
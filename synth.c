@@ -0,0 +1,777 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "envgen.h"
+#include "lfogen.h"
+#include "modmatrix.h"
+#include "vcf.h"
+#include "wavetable.h"
+#include "wavfile.h"
+#include "synth.h"
+
+/* Longest release rendered after a note is released, in seconds */
+#define SYNTH_MAX_RELEASE 60
+
+/* Frames rendered between writes to a file */
+#define SYNTH_RENDER_FRAMES 1024
+
+/* Offsets of the parameters of each oscillator and DCA */
+#define OSC_OCTAVE 0
+#define OSC_SEMITONE 1
+#define OSC_FINE 2
+#define OSC_WAVE 3
+#define OSC_MOD1_SRC 4
+#define OSC_MOD1_DEPTH 5
+#define OSC_MOD2_SRC 6
+#define OSC_MOD2_DEPTH 7
+#define OSC_STRIDE 8
+
+#define DCA_LEVEL 0
+#define DCA_OUTPUT 1
+#define DCA_MOD1_SRC 2
+#define DCA_MOD1_DEPTH 3
+#define DCA_MOD2_SRC 4
+#define DCA_MOD2_DEPTH 5
+#define DCA_STRIDE 6
+
+/* Modulation sources, in the order of their combo box entries */
+enum {
+    SRC_LFO1,
+    SRC_LFO2,
+    SRC_LFO3,
+    SRC_ENV1,
+    SRC_ENV2,
+    SRC_ENV3,
+    SRC_ENV4,
+    SRC_VELOCITY,
+    SRC_VELOCITY_X,
+    SRC_KEYBOARD,
+    SRC_KEYBOARD_2,
+    SRC_WHEEL,
+    SRC_PEDAL,
+    SRC_EXTERNAL,
+    SRC_PRESSURE,
+    SRC_OFF
+};
+
+/* Waves played by the oscillators */
+static WaveTable *wavetable = NULL;
+
+static gint allocate_voice(Synth *, gint);
+static void start_voice(Synth *, gint, gint, gint);
+static void start_envelopes(Synth *, gint);
+static void glide_voice(Synth *, gint, gint);
+static void release_voice(Synth *, gint);
+static void push_note(Synth *, gint);
+static void pop_note(Synth *, gint);
+static void update_controls(Synth *);
+static gfloat oscillator_pitch(const Synth *, gint, gint);
+static gfloat dca_gain(const Synth *, gint, gint);
+static guint32 next_random(guint32 *);
+
+/**
+   \brief Creates the wave table used by the software voices, unless one
+   has been loaded. This is safe to call from more than one thread.
+ */
+void
+synth_initialise(void)
+{
+    static gsize initialised = 0;
+
+    if (g_once_init_enter(&initialised)) {
+        if (!wavetable) {
+            wavetable = wavetable_new();
+        }
+        g_once_init_leave(&initialised, 1);
+    }
+}
+
+/**
+   \brief Loads the waves played by the software voices from a dump of the
+   SQ-80 wave ROM. This must be called before any voices are started.
+
+   \param filename - the name of the ROM dump.
+   \param error - set if the dump can't be loaded.
+   \return whether the dump was loaded.
+ */
+gboolean
+synth_load_waves(const gchar *filename, GError **error)
+{
+    WaveTable *table;
+
+    if (!(table = wavetable_load(filename, error))) {
+        return FALSE;
+    }
+
+    if (wavetable) {
+        wavetable_free(wavetable);
+    }
+    wavetable = table;
+
+    return TRUE;
+}
+
+/**
+   \brief Creates a software synthesizer with eight voices playing a patch.
+
+   \param parameters - the parameters of the patch, which are copied.
+   \param rate - the sample rate.
+   \return the newly created synthesizer.
+ */
+Synth *
+synth_new(const guchar *parameters, gint rate)
+{
+    Synth *synth;
+    gint i, v;
+
+    synth_initialise();
+
+    synth = g_new0(Synth, 1);
+    synth->rate = rate;
+    synth->seed = 0x9e3779b9U;
+
+    for (i = 0; i < SYNTH_LFO_COUNT; ++i) {
+        for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+            lfogen_init(&synth->lfos[i][v], next_random(&synth->seed));
+        }
+    }
+
+    synth_set_parameters(synth, parameters);
+
+    return synth;
+}
+
+/**
+   \brief Prepares the waves played by the oscillators of a patch, so that
+   changing to the patch with synth_set_parameters() doesn't need to build
+   them. This is safe to call from more than one thread.
+
+   \param parameters - the parameters of the patch.
+ */
+void
+synth_prepare(const guchar *parameters)
+{
+    gint i;
+
+    synth_initialise();
+
+    for (i = 0; i < SYNTH_OSCILLATOR_COUNT; ++i) {
+        wavetable_prepare(wavetable, parameters[PARAMETER_OSC1_WAVE + i * OSC_STRIDE] % WAVETABLE_WAVE_COUNT);
+    }
+}
+
+/**
+   \brief Changes the patch played by a synthesizer. Playing voices follow
+   the new parameters from the next control block, while the envelopes and
+   LFOs only pick up new shapes when a note starts.
+
+   \param synth - the synthesizer.
+   \param parameters - the parameters of the patch, which are copied.
+ */
+void
+synth_set_parameters(Synth *synth, const guchar *parameters)
+{
+    gint i, v, w;
+
+    memcpy(synth->parameters, parameters, PARAMETER_COUNT);
+
+    modmatrix_compile(&synth->matrix, parameters);
+
+    synth_prepare(parameters);
+
+    for (i = 0; i < SYNTH_OSCILLATOR_COUNT; ++i) {
+        w = parameters[PARAMETER_OSC1_WAVE + i * OSC_STRIDE] % WAVETABLE_WAVE_COUNT;
+        for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+            synth->waves[i][v] = wavetable_lookup(wavetable, w, synth->increments[i][v]);
+        }
+    }
+
+    for (i = 0; i < SYNTH_LFO_COUNT; ++i) {
+        lfogen_params(&synth->lfo_params[i], &parameters[PARAMETER_LFO1_FREQUENCY + i * LFOGEN_PARAMETER_COUNT], synth->rate / SYNTH_BLOCK_SIZE);
+    }
+
+    /* update the playing voices straight away */
+    synth->countdown = 0;
+}
+
+/**
+   \brief Frees a software synthesizer.
+
+   \param synth - the synthesizer.
+ */
+void
+synth_free(Synth *synth)
+{
+    g_free(synth);
+}
+
+/**
+   \brief Starts playing a note. In mono mode the most recent held note is
+   played by a single voice, otherwise a free voice is used if there is one,
+   or the quietest released or oldest held voice is stolen.
+
+   \param synth - the synthesizer.
+   \param note - the MIDI note number.
+   \param velocity - the note on velocity.
+ */
+void
+synth_note_on(Synth *synth, gint note, gint velocity)
+{
+    if (!synth->parameters[PARAMETER_MONO]) {
+        start_voice(synth, allocate_voice(synth, note), note, velocity);
+        return;
+    }
+
+    push_note(synth, note);
+
+    if (synth->active[0] && synth->held[0]) {
+        synth->velocity[0] = velocity;
+        glide_voice(synth, 0, note);
+    } else {
+        start_voice(synth, 0, note, velocity);
+    }
+}
+
+/**
+   \brief Releases a note. In mono mode the voice returns to the most recent
+   note still held, if there is one.
+
+   \param synth - the synthesizer.
+   \param note - the MIDI note number.
+ */
+void
+synth_note_off(Synth *synth, gint note)
+{
+    gint v;
+
+    if (!synth->parameters[PARAMETER_MONO]) {
+        for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+            if (synth->held[v] && synth->note[v] == note) {
+                release_voice(synth, v);
+            }
+        }
+        return;
+    }
+
+    pop_note(synth, note);
+
+    if (!synth->held[0] || synth->note[0] != note) {
+        return;
+    }
+
+    if (synth->note_count > 0) {
+        glide_voice(synth, 0, synth->notes[synth->note_count - 1]);
+    } else {
+        release_voice(synth, 0);
+    }
+}
+
+/**
+   \brief Releases all the notes being played.
+
+   \param synth - the synthesizer.
+ */
+void
+synth_all_notes_off(Synth *synth)
+{
+    gint v;
+
+    synth->note_count = 0;
+
+    for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+        if (synth->held[v]) {
+            release_voice(synth, v);
+        }
+    }
+}
+
+/**
+   \brief Renders the voices of a synthesizer, adding their output to a pair
+   of buffers.
+
+   \param synth - the synthesizer.
+   \param left - the buffer for the left channel.
+   \param right - the buffer for the right channel.
+   \param frames - the number of frames to render.
+   \return whether any voices are still playing.
+ */
+gboolean
+synth_process(Synth *synth, gfloat *left, gfloat *right, gint frames)
+{
+    gfloat osc[SYNTH_OSCILLATOR_COUNT][SYNTH_BLOCK_SIZE][SYNTH_VOICE_COUNT];
+    gfloat mix[SYNTH_BLOCK_SIZE][SYNTH_VOICE_COUNT];
+    gfloat wrapped[SYNTH_BLOCK_SIZE][SYNTH_VOICE_COUNT];
+    gfloat phase, index, x;
+    gint i, j, n, v, k;
+    gboolean playing, sync;
+
+    sync = synth->parameters[PARAMETER_SYNC] ? TRUE : FALSE;
+
+    for (playing = FALSE, v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+        playing |= synth->active[v];
+    }
+
+    while (playing && frames > 0) {
+        if (synth->countdown == 0) {
+            update_controls(synth);
+            synth->countdown = SYNTH_BLOCK_SIZE;
+        }
+
+        n = MIN(frames, (gint) synth->countdown);
+
+        /* oscillators, with oscillator 2 restarted by oscillator 1 in sync mode */
+
+        for (i = 0; i < SYNTH_OSCILLATOR_COUNT; ++i) {
+            for (j = 0; j < n; ++j) {
+                for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+                    phase = synth->phases[i][v];
+                    if (i == 1 && sync) {
+                        phase *= 1.0f - wrapped[j][v];
+                    }
+                    index = phase * WAVETABLE_LENGTH;
+                    k = (gint) index;
+                    x = index - k;
+                    osc[i][j][v] = synth->waves[i][v][k] + x * (synth->waves[i][v][k + 1] - synth->waves[i][v][k]);
+                    phase += synth->increments[i][v];
+                    if (i == 0) {
+                        wrapped[j][v] = phase >= 1.0f ? 1.0f : 0.0f;
+                    }
+                    synth->phases[i][v] = phase - (gint) phase;
+                }
+            }
+        }
+
+        /* oscillator 1 modulates the amplitude of oscillator 2 in AM mode */
+
+        if (synth->parameters[PARAMETER_AMPLITUDE_MODULATION]) {
+            for (j = 0; j < n; ++j) {
+                for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+                    osc[1][j][v] *= osc[0][j][v];
+                }
+            }
+        }
+
+        /* DCAs 1 to 3 */
+
+        for (j = 0; j < n; ++j) {
+            for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+                mix[j][v] = osc[0][j][v] * (synth->gains[0][v] + synth->gain_steps[0][v] * j)
+                    + osc[1][j][v] * (synth->gains[1][v] + synth->gain_steps[1][v] * j)
+                    + osc[2][j][v] * (synth->gains[2][v] + synth->gain_steps[2][v] * j);
+            }
+        }
+
+        vcf_process(&synth->filter, mix, n);
+
+        /* DCA 4, panning and summing the voices */
+
+        for (j = 0; j < n; ++j) {
+            for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+                x = mix[j][v] * (synth->gains[3][v] + synth->gain_steps[3][v] * j);
+                left[j] += x * synth->left[v];
+                right[j] += x * synth->right[v];
+            }
+        }
+
+        for (i = 0; i < SYNTH_DCA_COUNT; ++i) {
+            for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+                synth->gains[i][v] += synth->gain_steps[i][v] * n;
+            }
+        }
+
+        synth->countdown -= n;
+        left += n;
+        right += n;
+        frames -= n;
+
+        if (synth->countdown == 0) {
+            for (playing = FALSE, v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+                if (synth->active[v] && synth->envelopes[3][v].stage == ENVGEN_STAGE_DONE) {
+                    synth->active[v] = FALSE;
+                    for (i = 0; i < SYNTH_DCA_COUNT; ++i) {
+                        synth->gains[i][v] = 0;
+                        synth->gain_steps[i][v] = 0;
+                    }
+                    vcf_reset(&synth->filter, v);
+                }
+                playing |= synth->active[v];
+            }
+        }
+    }
+
+    return playing;
+}
+
+/**
+   \brief Renders notes played together with a patch to a WAV file.
+
+   \param patch - the patch.
+   \param notes - the MIDI note numbers.
+   \param count - the number of notes.
+   \param velocity - the note on velocity.
+   \param duration - the time in seconds before the notes are released.
+   \param filename - the name of the WAV file.
+   \param error - set if the file can't be written.
+   \return whether the file was written.
+ */
+gboolean
+synth_render(const Patch *patch, const gint *notes, gint count, gint velocity, gfloat duration, const gchar *filename, GError **error)
+{
+    Synth *synth;
+    WavFile *wav;
+    gfloat left[SYNTH_RENDER_FRAMES], right[SYNTH_RENDER_FRAMES];
+    guint frames, held, limit;
+    gint i, n, saved_errno;
+    gboolean playing, status;
+
+    if (!(wav = wavfile_open(filename, SYNTH_SAMPLE_RATE))) {
+        saved_errno = errno;
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(saved_errno), "%s: %s", filename, g_strerror(saved_errno));
+        return FALSE;
+    }
+
+    synth = synth_new(patch->parameters, SYNTH_SAMPLE_RATE);
+
+    for (i = 0; i < count; ++i) {
+        synth_note_on(synth, notes[i], velocity);
+    }
+
+    held = duration * SYNTH_SAMPLE_RATE;
+    limit = held + SYNTH_MAX_RELEASE * SYNTH_SAMPLE_RATE;
+    playing = TRUE;
+    status = TRUE;
+    saved_errno = 0;
+
+    for (frames = 0; playing && status && frames < limit; frames += n) {
+        if (frames >= held) {
+            synth_all_notes_off(synth);
+            n = SYNTH_RENDER_FRAMES;
+        } else {
+            n = MIN(SYNTH_RENDER_FRAMES, held - frames);
+        }
+
+        memset(left, 0, n * sizeof(gfloat));
+        memset(right, 0, n * sizeof(gfloat));
+
+        playing = synth_process(synth, left, right, n);
+        if (!(status = wavfile_write(wav, left, right, n))) {
+            saved_errno = errno;
+        }
+    }
+
+    synth_free(synth);
+
+    /* report the first failure, as closing after a failed write may fail too */
+    if (!wavfile_close(wav) && status) {
+        status = FALSE;
+        saved_errno = errno;
+    }
+
+    if (!status) {
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(saved_errno), "%s: %s", filename, g_strerror(saved_errno));
+    }
+
+    return status;
+}
+
+/*
+ * Returns the voice to play a note with: the voice already playing the
+ * note, the voice that has been free the longest, the quietest released
+ * voice, or the oldest held voice, in that order.
+ */
+static gint
+allocate_voice(Synth *synth, gint note)
+{
+    gint v, best;
+
+    for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+        if (synth->active[v] && synth->note[v] == note) {
+            return v;
+        }
+    }
+
+    for (best = -1, v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+        if (!synth->active[v] && (best < 0 || synth->started[v] < synth->started[best])) {
+            best = v;
+        }
+    }
+
+    if (best < 0) {
+        for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+            if (!synth->held[v] && (best < 0 || synth->envelopes[3][v].level < synth->envelopes[3][best].level)) {
+                best = v;
+            }
+        }
+    }
+
+    if (best < 0) {
+        for (best = 0, v = 1; v < SYNTH_VOICE_COUNT; ++v) {
+            if (synth->started[v] < synth->started[best]) {
+                best = v;
+            }
+        }
+    }
+
+    return best;
+}
+
+static void
+start_voice(Synth *synth, gint v, gint note, gint velocity)
+{
+    const guchar *parameters = synth->parameters;
+    gint i;
+
+    synth->velocity[v] = velocity;
+
+    /* a voice glides from the last note it played */
+    if (synth->started[v] && parameters[PARAMETER_GLIDE]) {
+        glide_voice(synth, v, note);
+    } else {
+        synth->note[v] = note;
+        synth->pitch[v] = note;
+        synth->glide[v] = 0;
+    }
+
+    start_envelopes(synth, v);
+
+    if (parameters[PARAMETER_OSCILLATOR_RESTART]) {
+        for (i = 0; i < SYNTH_OSCILLATOR_COUNT; ++i) {
+            synth->phases[i][v] = 0;
+        }
+    }
+
+    for (i = 0; i < SYNTH_LFO_COUNT; ++i) {
+        lfogen_start(&synth->lfos[i][v], &synth->lfo_params[i]);
+    }
+
+    synth->sources[SRC_VELOCITY][v] = velocity / 127.0f;
+    synth->sources[SRC_VELOCITY_X][v] = (velocity / 127.0f) * (velocity / 127.0f);
+    synth->sources[SRC_KEYBOARD][v] = (note - 64) / 64.0f;
+    synth->sources[SRC_KEYBOARD_2][v] = note / 127.0f;
+
+    synth->held[v] = TRUE;
+    synth->active[v] = TRUE;
+    synth->started[v] = ++synth->age;
+}
+
+/*
+ * Starts the envelopes of a voice for its note, from zero if the voice is
+ * free or voice restart is on, otherwise from their current levels.
+ */
+static void
+start_envelopes(Synth *synth, gint v)
+{
+    const guchar *parameters = synth->parameters;
+    EnvParams params;
+    gint i;
+
+    for (i = 0; i < SYNTH_ENVELOPE_COUNT; ++i) {
+        envgen_params(&params, &parameters[PARAMETER_ENV1_LEVEL1 + i * ENVGEN_PARAMETER_COUNT], synth->note[v], synth->velocity[v]);
+        params.full_cycle = parameters[PARAMETER_ENVELOPE_FULL_CYCLE] ? TRUE : FALSE;
+        if (!synth->active[v] || parameters[PARAMETER_VOICE_RESTART]) {
+            envgen_start(&synth->envelopes[i][v], &params, synth->rate / SYNTH_BLOCK_SIZE);
+        } else {
+            envgen_retrigger(&synth->envelopes[i][v], &params, synth->rate / SYNTH_BLOCK_SIZE);
+        }
+    }
+}
+
+/*
+ * Moves a voice to a new note, over the glide time if there is one. In mono
+ * mode the envelopes only restart if envelope restart is on.
+ */
+static void
+glide_voice(Synth *synth, gint v, gint note)
+{
+    const guchar *parameters = synth->parameters;
+    gfloat time;
+
+    synth->note[v] = note;
+
+    if (parameters[PARAMETER_GLIDE]) {
+        time = envgen_time(parameters[PARAMETER_GLIDE]);
+        synth->glide[v] = (note - synth->pitch[v]) * SYNTH_BLOCK_SIZE / (time * synth->rate);
+    } else {
+        synth->pitch[v] = note;
+        synth->glide[v] = 0;
+    }
+
+    synth->sources[SRC_KEYBOARD][v] = (note - 64) / 64.0f;
+    synth->sources[SRC_KEYBOARD_2][v] = note / 127.0f;
+
+    if (parameters[PARAMETER_MONO] && synth->held[v] && parameters[PARAMETER_ENVELOPE_RESTART]) {
+        start_envelopes(synth, v);
+    }
+}
+
+static void
+release_voice(Synth *synth, gint v)
+{
+    gint i;
+
+    synth->held[v] = FALSE;
+
+    for (i = 0; i < SYNTH_ENVELOPE_COUNT; ++i) {
+        envgen_release(&synth->envelopes[i][v]);
+    }
+}
+
+/*
+ * Adds a note to the top of the stack of held notes, dropping the oldest
+ * note if the stack is full.
+ */
+static void
+push_note(Synth *synth, gint note)
+{
+    pop_note(synth, note);
+
+    if (synth->note_count == SYNTH_NOTE_STACK) {
+        memmove(synth->notes, synth->notes + 1, (SYNTH_NOTE_STACK - 1) * sizeof(gint));
+        --synth->note_count;
+    }
+
+    synth->notes[synth->note_count++] = note;
+}
+
+static void
+pop_note(Synth *synth, gint note)
+{
+    gint i;
+
+    for (i = 0; i < synth->note_count; ++i) {
+        if (synth->notes[i] == note) {
+            memmove(synth->notes + i, synth->notes + i + 1, (synth->note_count - i - 1) * sizeof(gint));
+            --synth->note_count;
+            break;
+        }
+    }
+}
+
+/*
+ * Updates the modulation sources of the playing voices, then evaluates the
+ * modulation routes for all the voices at once and updates the values
+ * derived from them, which the DCAs ramp between over the following block.
+ */
+static void
+update_controls(Synth *synth)
+{
+    const guchar *parameters = synth->parameters;
+    gfloat hz, gain, pan;
+    gint i, v, w;
+
+    for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+        if (!synth->active[v]) {
+            continue;
+        }
+
+        /* the LFO routes were evaluated at the end of the previous block */
+        for (i = 0; i < SYNTH_LFO_COUNT; ++i) {
+            synth->sources[SRC_LFO1 + i][v] = lfogen_step(&synth->lfos[i][v], synth->destinations[MOD_LFO1_LEVEL + i][v]);
+        }
+
+        for (i = 0; i < SYNTH_ENVELOPE_COUNT; ++i) {
+            synth->sources[SRC_ENV1 + i][v] = envgen_step(&synth->envelopes[i][v]);
+        }
+
+        if (synth->glide[v] != 0) {
+            synth->pitch[v] += synth->glide[v];
+            if ((synth->glide[v] > 0 && synth->pitch[v] >= synth->note[v]) || (synth->glide[v] < 0 && synth->pitch[v] <= synth->note[v])) {
+                synth->pitch[v] = synth->note[v];
+                synth->glide[v] = 0;
+            }
+        }
+    }
+
+    modmatrix_evaluate(&synth->matrix, &synth->sources[0][0], &synth->destinations[0][0], SYNTH_VOICE_COUNT);
+
+    for (v = 0; v < SYNTH_VOICE_COUNT; ++v) {
+        if (!synth->active[v]) {
+            continue;
+        }
+
+        for (i = 0; i < SYNTH_OSCILLATOR_COUNT; ++i) {
+            w = parameters[PARAMETER_OSC1_WAVE + i * OSC_STRIDE] % WAVETABLE_WAVE_COUNT;
+            hz = 440.0f * exp2f((oscillator_pitch(synth, i, v) - 69.0f) / 12.0f);
+            synth->increments[i][v] = MIN(hz / synth->rate, 0.5f);
+            synth->waves[i][v] = wavetable_lookup(wavetable, w, synth->increments[i][v]);
+        }
+
+        for (i = 0; i < SYNTH_DCA_COUNT; ++i) {
+            gain = dca_gain(synth, i, v);
+            synth->gain_steps[i][v] = (gain - synth->gains[i][v]) / SYNTH_BLOCK_SIZE;
+        }
+
+        vcf_update(&synth->filter, v, &parameters[PARAMETER_FILTER_FREQUENCY], synth->pitch[v], synth->destinations[MOD_FILTER_FREQUENCY][v], synth->rate, SYNTH_BLOCK_SIZE);
+
+        /* pan positions 0 to 15 with 8 in the centre, modulated across the full width */
+        pan = parameters[PARAMETER_DCA4_PAN] + synth->destinations[MOD_PAN][v] * 8.0f;
+        pan = CLAMP(pan, 0.0f, 16.0f);
+        synth->left[v] = cosf(pan / 16.0f * G_PI_2);
+        synth->right[v] = sinf(pan / 16.0f * G_PI_2);
+    }
+}
+
+/*
+ * Returns the pitch of an oscillator as a note number, with each modulation
+ * depth of 63 giving up to an octave.
+ */
+static gfloat
+oscillator_pitch(const Synth *synth, gint i, gint v)
+{
+    const guchar *parameters = &synth->parameters[PARAMETER_OSC1_OCTAVE + i * OSC_STRIDE];
+
+    return synth->pitch[v]
+        + 12 * (gint8) parameters[OSC_OCTAVE]
+        + parameters[OSC_SEMITONE]
+        + parameters[OSC_FINE] / 32.0f
+        + synth->destinations[MOD_OSC1_PITCH + i][v] * 12.0f;
+}
+
+static gfloat
+dca_gain(const Synth *synth, gint i, gint v)
+{
+    const guchar *parameters = synth->parameters;
+    gint offset = PARAMETER_DCA1_LEVEL + i * DCA_STRIDE;
+    gfloat gain;
+
+    if (i == 3) {
+        gain = synth->sources[SRC_ENV4][v] * parameters[PARAMETER_DCA4_ENV4_DEPTH] / 63.0f;
+    } else if (parameters[offset + DCA_OUTPUT]) {
+        gain = parameters[offset + DCA_LEVEL] / 63.0f + synth->destinations[MOD_DCA1_LEVEL + i][v];
+    } else {
+        gain = 0;
+    }
+
+    /* leave headroom for three oscillators at full level */
+    return CLAMP(gain, 0.0f, 1.0f) * (i == 3 ? 1.0f : 0.33f);
+}
+
+static guint32
+next_random(guint32 *seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+
+    return *seed;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#define SYNTH_SAMPLE_RATE 44100
+
+/* Number of frames between updates of the modulation sources */
+#define SYNTH_BLOCK_SIZE 32
+
+#define SYNTH_VOICE_COUNT 8
+#define SYNTH_OSCILLATOR_COUNT 3
+#define SYNTH_ENVELOPE_COUNT 4
+#define SYNTH_LFO_COUNT 3
+#define SYNTH_DCA_COUNT 4
+
+/* Number of held notes remembered in mono mode */
+#define SYNTH_NOTE_STACK 16
+
+/*
+ * The state of the voices is held in arrays indexed by voice, so each stage
+ * of rendering is a loop over all the voices at once.
+ */
+typedef struct {
+    guchar parameters[PARAMETER_COUNT];
+    gfloat rate;
+    guint countdown;
+    guint32 seed;
+    guint age;
+    gint notes[SYNTH_NOTE_STACK];
+    gint note_count;
+    gint note[SYNTH_VOICE_COUNT];
+    gint velocity[SYNTH_VOICE_COUNT];
+    guint started[SYNTH_VOICE_COUNT];
+    gboolean held[SYNTH_VOICE_COUNT];
+    gboolean active[SYNTH_VOICE_COUNT];
+    gfloat pitch[SYNTH_VOICE_COUNT];
+    gfloat glide[SYNTH_VOICE_COUNT];
+    ModMatrix matrix;
+    gfloat sources[MODMATRIX_SOURCE_COUNT][SYNTH_VOICE_COUNT];
+    gfloat destinations[MOD_DESTINATION_COUNT][SYNTH_VOICE_COUNT];
+    EnvGen envelopes[SYNTH_ENVELOPE_COUNT][SYNTH_VOICE_COUNT];
+    LfoParams lfo_params[SYNTH_LFO_COUNT];
+    LfoGen lfos[SYNTH_LFO_COUNT][SYNTH_VOICE_COUNT];
+    const gfloat *waves[SYNTH_OSCILLATOR_COUNT][SYNTH_VOICE_COUNT];
+    gfloat phases[SYNTH_OSCILLATOR_COUNT][SYNTH_VOICE_COUNT];
+    gfloat increments[SYNTH_OSCILLATOR_COUNT][SYNTH_VOICE_COUNT];
+    gfloat gains[SYNTH_DCA_COUNT][SYNTH_VOICE_COUNT];
+    gfloat gain_steps[SYNTH_DCA_COUNT][SYNTH_VOICE_COUNT];
+    Vcf filter;
+    gfloat left[SYNTH_VOICE_COUNT];
+    gfloat right[SYNTH_VOICE_COUNT];
+} Synth;
+
+void synth_initialise(void);
+gboolean synth_load_waves(const gchar *, GError **);
+
+Synth *synth_new(const guchar *, gint);
+void synth_free(Synth *);
+void synth_prepare(const guchar *);
+void synth_set_parameters(Synth *, const guchar *);
+void synth_note_on(Synth *, gint, gint);
+void synth_note_off(Synth *, gint);
+void synth_all_notes_off(Synth *);
+gboolean synth_process(Synth *, gfloat *, gfloat *, gint);
+
+gboolean synth_render(const Patch *, const gint *, gint, gint, gfloat, const gchar *, GError **);
+
+#endif /* !SYNTH_H */
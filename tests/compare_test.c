@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "parameters.h"
+#include "journal.h"
+#include "compare.h"
+
+Patch *current_patch = NULL;
+
+/*
+ * Switching from B back to A and undoing it must leave the patch, and the
+ * values sent to the synth, as they were at B.
+ */
+static void
+test_switch_undo(void)
+{
+    Patch patch;
+    Compare compare;
+    Journal *journal;
+    const JournalRecord *records[PARAMETER_COUNT];
+    guchar a[PARAMETER_COUNT], b[PARAMETER_COUNT], sent[PARAMETER_COUNT];
+    gint i, n;
+
+    memset(&patch, 0, sizeof(patch));
+    patch.parameters[PARAMETER_FILTER_FREQUENCY] = 40;
+    patch.parameters[PARAMETER_GLIDE] = 10;
+
+    journal = journal_new();
+    compare_init(&compare);
+
+    compare_store(&compare, COMPARE_A, &patch);
+    memcpy(a, patch.parameters, PARAMETER_COUNT);
+
+    /* edit two parameters, one of them signed, as the dialogs would */
+    journal_record(journal, &patch, PARAMETER_FILTER_FREQUENCY, 40, 90);
+    patch.parameters[PARAMETER_FILTER_FREQUENCY] = 90;
+    journal_record(journal, &patch, PARAMETER_ENV1_LEVEL2, 0, parameters_clamp(PARAMETER_ENV1_LEVEL2, -5));
+    patch.parameters[PARAMETER_ENV1_LEVEL2] = parameters_clamp(PARAMETER_ENV1_LEVEL2, -5);
+
+    compare_store(&compare, COMPARE_B, &patch);
+    memcpy(b, patch.parameters, PARAMETER_COUNT);
+
+    g_assert_true(compare_ready(&compare, &patch));
+
+    n = compare_switch(&compare, journal);
+    g_assert_cmpint(n, ==, 2);
+    g_assert_cmpmem(patch.parameters, PARAMETER_COUNT, a, PARAMETER_COUNT);
+
+    /* the switch sends the encoded A values of the differing parameters */
+    for (i = 0; i < n; ++i) {
+        g_assert_cmpuint(compare.encoded[compare.side][i], ==, parameters_encode(compare.differing[i], a[compare.differing[i]]));
+    }
+
+    /* one undo reverts the whole switch, sending the B values */
+    memset(sent, 0, sizeof(sent));
+    n = journal_undo(journal, records);
+    g_assert_cmpint(n, ==, 2);
+    for (i = 0; i < n; ++i) {
+        g_assert_true(records[i]->patch == &patch);
+        patch.parameters[records[i]->parameter] = records[i]->old_value;
+        sent[records[i]->parameter] = parameters_encode(records[i]->parameter, records[i]->old_value);
+    }
+    g_assert_cmpmem(patch.parameters, PARAMETER_COUNT, b, PARAMETER_COUNT);
+    g_assert_cmpuint(sent[PARAMETER_FILTER_FREQUENCY], ==, parameters_encode(PARAMETER_FILTER_FREQUENCY, 90));
+    g_assert_cmpuint(sent[PARAMETER_ENV1_LEVEL2], ==, parameters_encode(PARAMETER_ENV1_LEVEL2, b[PARAMETER_ENV1_LEVEL2]));
+
+    /* the next undo is the edit made before B was stored */
+    n = journal_undo(journal, records);
+    g_assert_cmpint(n, ==, 1);
+    g_assert_cmpint(records[0]->parameter, ==, PARAMETER_ENV1_LEVEL2);
+
+    journal_free(journal);
+}
+
+int
+main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/compare/switch-undo", test_switch_undo);
+
+    return g_test_run();
+}
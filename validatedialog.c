@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "parameters.h"
+#include "journal.h"
+#include "dialog.h"
+#include "duplicates.h"
+#include "validatedialog.h"
+
+/*
+ * Checks every patch in the list for values out of range, listing them, and
+ * brings them into range if asked. Returns whether the patch being edited
+ * was changed, so the caller can show its new values.
+ */
+gboolean
+run_validate_dialog(GtkWindow *parent, GtkTreeModel *patches, DuplicateIndex *duplicates, Journal *journal)
+{
+    GtkWidget *dialog;
+    GtkTreeIter iter;
+    Patch *patch;
+    guchar invalid[PARAMETER_COUNT], before[PARAMETER_COUNT];
+    gboolean valid, changed;
+    gint i, n, values, count;
+
+    values = 0;
+    count = 0;
+
+    for (valid = gtk_tree_model_get_iter_first(patches, &iter); valid; valid = gtk_tree_model_iter_next(patches, &iter)) {
+        gtk_tree_model_get(patches, &iter, DATA_COL, &patch, -1);
+
+        if ((n = parameters_check(patch->parameters, invalid)) > 0) {
+            for (i = 0; i < PARAMETER_COUNT; ++i) {
+                if (invalid[i]) {
+                    g_print("%s has %s out of range (%d)\n", patch->name, parameter_descriptors[i].name, parameters_decode(i, patch->parameters[i]));
+                }
+            }
+
+            values += n;
+            ++count;
+        }
+    }
+
+    if (count == 0) {
+        dialog = gtk_message_dialog_new(parent,
+            GTK_DIALOG_MODAL,
+            GTK_MESSAGE_INFO,
+            GTK_BUTTONS_CLOSE,
+            "All patches are in range");
+        gtk_dialog_run(GTK_DIALOG(dialog));
+        gtk_widget_destroy(dialog);
+        return FALSE;
+    }
+
+    dialog = gtk_message_dialog_new(parent,
+        GTK_DIALOG_MODAL,
+        GTK_MESSAGE_WARNING,
+        GTK_BUTTONS_NONE,
+        "%d values out of range in %d patches", values, count);
+    gtk_dialog_add_buttons(GTK_DIALOG(dialog), "Clamp", GTK_RESPONSE_ACCEPT, "Close", GTK_RESPONSE_CLOSE, NULL);
+
+    changed = FALSE;
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        for (valid = gtk_tree_model_get_iter_first(patches, &iter); valid; valid = gtk_tree_model_iter_next(patches, &iter)) {
+            gtk_tree_model_get(patches, &iter, DATA_COL, &patch, -1);
+
+            if (parameters_check(patch->parameters, invalid) > 0) {
+                memcpy(before, patch->parameters, PARAMETER_COUNT);
+                parameters_clamp_all(patch->parameters);
+                duplicates_add(duplicates, patch, NULL);
+
+                /* the patch being edited is playing, so it is changed like any other edit */
+                if (patch == current_patch) {
+                    journal_begin_group(journal);
+                    for (i = 0; i < PARAMETER_COUNT; ++i) {
+                        if (before[i] != patch->parameters[i]) {
+                            journal_record(journal, patch, i, before[i], patch->parameters[i]);
+                            queue_parameter(i, parameters_encode(i, patch->parameters[i]));
+                        }
+                    }
+                    journal_end_group(journal);
+                    changed = TRUE;
+                }
+            }
+        }
+    }
+
+    gtk_widget_destroy(dialog);
+
+    return changed;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "parameters.h"
+#include "variations.h"
+
+/* Chance, relative to the amount, of a wave, mod source or switch changing */
+#define VARIATIONS_CHOICE_RATE 0.25
+
+static guint64 next_random(guint64 *);
+static gdouble random_unit(guint64 *);
+
+/**
+   \brief Generates variations of a patch, by moving each slider a random
+   distance within its range and sometimes changing waves, mod sources and
+   switches. The same seed always gives the same variations.
+
+   \param parameters - the parameters of the patch to vary.
+   \param variations - the parameters of the variations to fill in, count
+   times PARAMETER_COUNT long.
+   \param count - the number of variations.
+   \param amount - how far to vary the patch, from 0 for not at all to 1 for
+   anywhere in each range.
+   \param seed - the seed of the random numbers.
+ */
+void
+variations_generate(const guchar *parameters, guchar *variations, gint count, gdouble amount, guint32 seed)
+{
+    const ParameterDescriptor *descriptor;
+    guchar *variation;
+    guint64 state;
+    gint i, j, value, span;
+    gdouble offset;
+
+    amount = CLAMP(amount, 0.0, 1.0);
+
+    /* xorshift needs a state that isn't zero */
+    state = ((guint64) seed << 32 | seed) ^ G_GUINT64_CONSTANT(0x9e3779b97f4a7c15);
+
+    for (i = 0; i < count; ++i) {
+        variation = variations + (gsize) i * PARAMETER_COUNT;
+
+        for (j = 0; j < PARAMETER_COUNT; ++j) {
+            descriptor = &parameter_descriptors[j];
+            span = descriptor->maximum - descriptor->minimum;
+
+            if (descriptor->kind == DESCRIPTOR_CHOICE || descriptor->kind == DESCRIPTOR_SWITCH) {
+                if (random_unit(&state) < amount * VARIATIONS_CHOICE_RATE) {
+                    value = descriptor->minimum + (gint) (random_unit(&state) * (span + 1));
+                } else {
+                    value = parameters[j];
+                }
+            } else {
+                value = parameters_decode(j, parameters[j]);
+
+                /* a triangular offset favours small moves over large ones */
+                offset = (random_unit(&state) - random_unit(&state)) * amount * span;
+                value += (gint) (offset < 0 ? offset - 0.5 : offset + 0.5);
+            }
+
+            variation[j] = parameters_clamp(j, value);
+        }
+    }
+}
+
+/*
+ * Returns the next number from a xorshift64* generator.
+ */
+static guint64
+next_random(guint64 *state)
+{
+    guint64 x = *state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x * G_GUINT64_CONSTANT(0x2545f4914f6cdd1d);
+}
+
+/*
+ * Returns a random number from 0 up to but not including 1.
+ */
+static gdouble
+random_unit(guint64 *state)
+{
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
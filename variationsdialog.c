@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+#include <gtk/gtk.h>
+
+#include "main.h"
+#include "patch.h"
+#include "dialog.h"
+#include "variations.h"
+#include "variationsdialog.h"
+
+/* Greatest number of variations generated at once */
+#define VARIATIONS_MAX_COUNT 10000
+
+/*
+ * Generates variations of a patch, returning them as new patches for the
+ * caller to add to the list, or NULL if the dialog was cancelled.
+ */
+Patch **
+run_variations_dialog(GtkWindow *parent, const Patch *base, gint *count)
+{
+    GtkWidget *dialog, *label, *number, *amount, *seed;
+    GtkGrid *grid;
+    Patch **patches;
+    guchar *variations;
+    gchar *name;
+    gint i, n;
+
+    dialog = gtk_dialog_new_with_buttons("Variations",
+        parent,
+        GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+        "_OK", GTK_RESPONSE_OK,
+        "_Cancel", GTK_RESPONSE_CANCEL,
+        NULL);
+
+    grid = create_grid(GTK_CONTAINER(gtk_dialog_get_content_area(GTK_DIALOG(dialog))));
+
+    label = gtk_label_new("Count:");
+    number = gtk_spin_button_new_with_range(1.0, VARIATIONS_MAX_COUNT, 1.0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(number), 16.0);
+    create_grid_row(grid, 0, GTK_LABEL(label), number);
+
+    label = gtk_label_new("Amount:");
+    amount = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 100, 1);
+    gtk_range_set_value(GTK_RANGE(amount), VARIATIONS_DEFAULT_AMOUNT * 100);
+    gtk_widget_set_size_request(amount, 192, -1);
+    create_grid_row(grid, 1, GTK_LABEL(label), amount);
+
+    label = gtk_label_new("Seed:");
+    seed = gtk_spin_button_new_with_range(0.0, G_MAXINT32, 1.0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(seed), g_random_int_range(0, G_MAXINT32));
+    create_grid_row(grid, 2, GTK_LABEL(label), seed);
+
+    gtk_widget_show_all(GTK_WIDGET(grid));
+
+    patches = NULL;
+    *count = 0;
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_OK) {
+        n = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(number));
+
+        variations = g_new(guchar, (gsize) n * PARAMETER_COUNT);
+        variations_generate(base->parameters, variations, n,
+            gtk_range_get_value(GTK_RANGE(amount)) / 100.0,
+            (guint32) gtk_spin_button_get_value(GTK_SPIN_BUTTON(seed)));
+
+        patches = g_new(Patch *, n);
+        for (i = 0; i < n; ++i) {
+            patches[i] = patch_new();
+            name = g_strdup_printf("%s %d", base->name, i + 1);
+            patch_set_name(patches[i], name, -1);
+            g_free(name);
+            patch_set_type(patches[i], base->type, -1);
+            memcpy(patches[i]->parameters, variations + (gsize) i * PARAMETER_COUNT, PARAMETER_COUNT);
+        }
+
+        g_free(variations);
+
+        *count = n;
+    }
+
+    gtk_widget_destroy(dialog);
+
+    return patches;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <math.h>
+
+#include <glib.h>
+
+#include "vcf.h"
+
+/* Offsets of the filter parameters from PARAMETER_FILTER_FREQUENCY */
+#define VCF_FREQUENCY 0
+#define VCF_RESONANCE 1
+#define VCF_KEYBOARD_TRACKING 2
+
+/* Key that keyboard tracking is relative to */
+#define VCF_TRACKING_KEY 60
+
+/* Feedback at the highest resonance, just short of self oscillation */
+#define VCF_MAX_FEEDBACK 3.8f
+
+/**
+   \brief Returns the cutoff frequency of the filter for a note. The
+   frequency parameter is a note number, and the modulation moves it over
+   its full range.
+
+   \param values - the parameters of the filter, starting with the frequency.
+   \param pitch - the pitch of the note as a MIDI note number.
+   \param mod - the sum of the modulation routes, from -2 to 2.
+   \return the cutoff frequency in Hz.
+ */
+gfloat
+vcf_frequency(const guchar *values, gfloat pitch, gfloat mod)
+{
+    gfloat note;
+
+    note = values[VCF_FREQUENCY]
+        + values[VCF_KEYBOARD_TRACKING] / 63.0f * (pitch - VCF_TRACKING_KEY)
+        + mod * 127.0f;
+
+    return 440.0f * exp2f((note - 69.0f) / 12.0f);
+}
+
+/**
+   \brief Sets the coefficients a voice of the filter moves to over the
+   next block.
+
+   \param vcf - the filter.
+   \param v - the voice.
+   \param values - the parameters of the filter, starting with the frequency.
+   \param pitch - the pitch of the note as a MIDI note number.
+   \param mod - the sum of the modulation routes, from -2 to 2.
+   \param rate - the sample rate.
+   \param frames - the number of frames in the block.
+ */
+void
+vcf_update(Vcf *vcf, gint v, const guchar *values, gfloat pitch, gfloat mod, gfloat rate, gint frames)
+{
+    gfloat hz, cutoff, resonance;
+
+    hz = CLAMP(vcf_frequency(values, pitch, mod), 20.0f, rate * 0.45f);
+    cutoff = 1.0f - expf(-2.0f * G_PI * hz / rate);
+    resonance = values[VCF_RESONANCE] / 31.0f * VCF_MAX_FEEDBACK;
+
+    vcf->cutoff_step[v] = (cutoff - vcf->cutoff[v]) / frames;
+    vcf->resonance_step[v] = (resonance - vcf->resonance[v]) / frames;
+}
+
+/**
+   \brief Silences a voice of the filter, ready for a new note.
+
+   \param vcf - the filter.
+   \param v - the voice.
+ */
+void
+vcf_reset(Vcf *vcf, gint v)
+{
+    gint i;
+
+    for (i = 0; i < 4; ++i) {
+        vcf->poles[i][v] = 0;
+    }
+}
+
+/**
+   \brief Filters a block of audio for all the voices at once, moving the
+   coefficients a step each frame. The input to the four one pole stages is
+   soft clipped to keep high resonance stable.
+
+   \param vcf - the filter.
+   \param buffer - the audio, filtered in place.
+   \param frames - the number of frames to filter.
+ */
+void
+vcf_process(Vcf *vcf, gfloat (*buffer)[VCF_VOICE_COUNT], gint frames)
+{
+    gfloat x, g;
+    gint j, v;
+
+    for (j = 0; j < frames; ++j) {
+        for (v = 0; v < VCF_VOICE_COUNT; ++v) {
+            g = vcf->cutoff[v];
+            x = buffer[j][v] - vcf->resonance[v] * vcf->poles[3][v];
+            x = x / (1.0f + fabsf(x));
+            vcf->poles[0][v] += g * (x - vcf->poles[0][v]);
+            vcf->poles[1][v] += g * (vcf->poles[0][v] - vcf->poles[1][v]);
+            vcf->poles[2][v] += g * (vcf->poles[1][v] - vcf->poles[2][v]);
+            vcf->poles[3][v] += g * (vcf->poles[2][v] - vcf->poles[3][v]);
+            buffer[j][v] = vcf->poles[3][v];
+            vcf->cutoff[v] += vcf->cutoff_step[v];
+            vcf->resonance[v] += vcf->resonance_step[v];
+        }
+    }
+}
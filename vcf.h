@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef VCF_H
+#define VCF_H
+
+/* Number of filter parameters from PARAMETER_FILTER_FREQUENCY */
+#define VCF_PARAMETER_COUNT 7
+
+/* Number of voices filtered together, matching the software synthesizer */
+#define VCF_VOICE_COUNT 8
+
+typedef struct {
+    gfloat cutoff[VCF_VOICE_COUNT];
+    gfloat cutoff_step[VCF_VOICE_COUNT];
+    gfloat resonance[VCF_VOICE_COUNT];
+    gfloat resonance_step[VCF_VOICE_COUNT];
+    gfloat poles[4][VCF_VOICE_COUNT];
+} Vcf;
+
+gfloat vcf_frequency(const guchar *, gfloat, gfloat);
+
+void vcf_update(Vcf *, gint, const guchar *, gfloat, gfloat, gfloat, gint);
+void vcf_reset(Vcf *, gint);
+void vcf_process(Vcf *, gfloat (*)[VCF_VOICE_COUNT], gint);
+
+#endif /* !VCF_H */
@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+
+#include "wavetable.h"
+
+/* Offset of a cosine in the table of sines */
+#define COSINE (WAVETABLE_LENGTH / 4)
+
+/* Zero level of the unsigned 8 bit samples in a ROM dump */
+#define ROM_ZERO 0x80
+
+typedef enum {
+    SHAPE_SAWTOOTH,
+    SHAPE_SQUARE,
+    SHAPE_PULSE,
+    SHAPE_TRIANGLE,
+    SHAPE_SINE,
+    SHAPE_PARTIALS,
+    SHAPE_NOISE
+} WaveShape;
+
+typedef struct {
+    WaveShape shape;
+    guint32 partials;
+} WaveRecipe;
+
+#define H(n) (1U << ((n) - 1))
+
+/*
+ * Stand-ins for the waves in the SQ-80 ROM, in the same order as the
+ * oscillator wave combo boxes. Each is a single cycle built from the
+ * harmonics of a basic shape, or from a set of harmonics with amplitudes
+ * falling off as 1/n. The sampled and noise waves are approximated by a
+ * looped cycle of random values.
+ */
+static const WaveRecipe wave_recipes[WAVETABLE_WAVE_COUNT] = {
+    { SHAPE_SAWTOOTH, 0 },                                          /* Sawtooth */
+    { SHAPE_PARTIALS, H(1) | H(4) | H(7) | H(11) | H(17) | H(23) },  /* Bell */
+    { SHAPE_SINE, 0 },                                              /* Sine */
+    { SHAPE_SQUARE, 0 },                                            /* Square */
+    { SHAPE_PULSE, 0 },                                             /* Pulse */
+    { SHAPE_NOISE, 0 },                                             /* Noise 1 */
+    { SHAPE_NOISE, 0 },                                             /* Noise 2 */
+    { SHAPE_NOISE, 0 },                                             /* Noise 3 */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(4) | H(5) },           /* Bass */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(4) | H(5) | H(6) | H(8) | H(10) | H(12) }, /* Piano */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(4) | H(7) | H(14) },          /* Electric Piano */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(4) | H(8) | H(9) },    /* Voice 1 */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(5) | H(6) | H(11) | H(12) },  /* Voice 2 */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) },                         /* Kick */
+    { SHAPE_PARTIALS, H(1) | H(3) | H(5) | H(7) | H(9) | H(11) | H(13) }, /* Reed */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(4) | H(6) | H(8) | H(16) }, /* Organ */
+    { SHAPE_SAWTOOTH, 0 },                                          /* Synth 1 */
+    { SHAPE_SQUARE, 0 },                                            /* Synth 2 */
+    { SHAPE_PULSE, 0 },                                             /* Synth 3 */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(4) },                  /* Formant 1 */
+    { SHAPE_PARTIALS, H(1) | H(3) | H(4) | H(5) },                  /* Formant 2 */
+    { SHAPE_PARTIALS, H(1) | H(4) | H(5) | H(6) },                  /* Formant 3 */
+    { SHAPE_PARTIALS, H(1) | H(5) | H(6) | H(7) },                  /* Formant 4 */
+    { SHAPE_PARTIALS, H(1) | H(6) | H(7) | H(8) },                  /* Formant 5 */
+    { SHAPE_PULSE, 0 },                                             /* Pulse 2 */
+    { SHAPE_SQUARE, 0 },                                            /* Square 2 */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(4) | H(8) },                  /* Four Octaves */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(5) | H(7) | H(11) | H(13) | H(17) | H(19) | H(23) }, /* Prime */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(5) },                  /* Bass 2 */
+    { SHAPE_PARTIALS, H(1) | H(3) | H(6) | H(9) },                  /* Electric Piano 2 */
+    { SHAPE_PARTIALS, H(1) | H(2) },                                /* Octave */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) },                         /* Octave And Fifth */
+    { SHAPE_SAWTOOTH, 0 },                                          /* Sawtooth 2 */
+    { SHAPE_TRIANGLE, 0 },                                          /* Triangle */
+    { SHAPE_PARTIALS, H(1) | H(3) | H(5) | H(7) },                  /* Reed 2 */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(5) | H(7) | H(9) },    /* Reed 3 */
+    { SHAPE_PARTIALS, H(1) | H(13) | H(14) | H(15) | H(16) },       /* Grit 1 */
+    { SHAPE_PARTIALS, H(1) | H(19) | H(20) | H(21) | H(22) },       /* Grit 2 */
+    { SHAPE_PARTIALS, H(1) | H(25) | H(26) | H(27) | H(28) },       /* Grit 3 */
+    { SHAPE_PARTIALS, H(1) | H(8) | H(12) },                        /* Glint 1 */
+    { SHAPE_PARTIALS, H(1) | H(10) | H(16) },                       /* Glint 2 */
+    { SHAPE_PARTIALS, H(1) | H(12) | H(20) },                       /* Glint 3 */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(4) | H(5) | H(6) | H(7) | H(8) | H(9) | H(10) | H(11) | H(12) }, /* Clav */
+    { SHAPE_SAWTOOTH, 0 },                                          /* Brass */
+    { SHAPE_SAWTOOTH, 0 },                                          /* String */
+    { SHAPE_PARTIALS, H(1) | H(5) | H(9) | H(13) },                 /* Digit 1 */
+    { SHAPE_PARTIALS, H(1) | H(7) | H(15) | H(23) },                /* Digit 2 */
+    { SHAPE_PARTIALS, H(1) | H(6) | H(10) | H(15) | H(21) },        /* Bell 2 */
+    { SHAPE_PARTIALS, H(1) | H(17) | H(19) | H(29) },               /* Alien */
+    { SHAPE_NOISE, 0 },                                             /* Breath */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(7) | H(8) },           /* Voice 3 */
+    { SHAPE_NOISE, 0 },                                             /* Steam */
+    { SHAPE_PARTIALS, H(1) | H(11) | H(13) | H(17) | H(19) | H(23) }, /* Metal */
+    { SHAPE_PARTIALS, H(1) | H(4) | H(9) | H(16) | H(25) },         /* Chime */
+    { SHAPE_SAWTOOTH, 0 },                                          /* Bowing */
+    { SHAPE_NOISE, 0 },                                             /* Pick 1 */
+    { SHAPE_NOISE, 0 },                                             /* Pick 2 */
+    { SHAPE_PARTIALS, H(1) | H(4) | H(10) },                        /* Mallet */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) | H(4) },                  /* Slap */
+    { SHAPE_PARTIALS, H(1) | H(6) | H(12) },                        /* Plink */
+    { SHAPE_SAWTOOTH, 0 },                                          /* Pluck */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(3) },                         /* Plunk */
+    { SHAPE_NOISE, 0 },                                             /* Click */
+    { SHAPE_NOISE, 0 },                                             /* Chiff */
+    { SHAPE_PARTIALS, H(1) | H(2) },                                /* Thump */
+    { SHAPE_PARTIALS, H(1) | H(3) | H(7) },                         /* Log Drum */
+    { SHAPE_PARTIALS, H(1) | H(2) },                                /* Kick 2 */
+    { SHAPE_NOISE, 0 },                                             /* Snare */
+    { SHAPE_PARTIALS, H(1) | H(2) | H(5) },                         /* Tom Tom */
+    { SHAPE_NOISE, 0 },                                             /* Hi Hat */
+    { SHAPE_NOISE, 0 },                                             /* Drums 1 */
+    { SHAPE_NOISE, 0 },                                             /* Drums 2 */
+    { SHAPE_NOISE, 0 },                                             /* Drums 3 */
+    { SHAPE_NOISE, 0 },                                             /* Drums 4 */
+    { SHAPE_NOISE, 0 }                                              /* Drums 5 */
+};
+
+static WaveTable *wavetable_alloc(void);
+static void build_recipe(const WaveTable *, gint, gfloat *);
+static void build_rom(const WaveTable *, gint, gfloat *);
+static void build_levels(WaveTable *, gint, gfloat *);
+
+/**
+   \brief Creates a wave table with stand-ins for the waves in the SQ-80
+   ROM. The band limited levels of each wave are built the first time the
+   wave is prepared.
+
+   \return the newly created wave table.
+ */
+WaveTable *
+wavetable_new(void)
+{
+    return wavetable_alloc();
+}
+
+/**
+   \brief Creates a wave table from a dump of the SQ-80 wave ROM. The dump
+   is memory mapped rather than read, and holds a page of 256 unsigned 8 bit
+   samples for each wave, in the order of the oscillator wave combo boxes.
+
+   \param filename - the name of the ROM dump.
+   \param error - set if the dump can't be mapped or is too short.
+   \return the newly created wave table, or NULL on error.
+ */
+WaveTable *
+wavetable_load(const gchar *filename, GError **error)
+{
+    GMappedFile *rom;
+    WaveTable *table;
+
+    if (!(rom = g_mapped_file_new(filename, FALSE, error))) {
+        return NULL;
+    }
+
+    if (g_mapped_file_get_length(rom) < WAVETABLE_WAVE_COUNT * WAVETABLE_LENGTH) {
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "%s is too short for %d waves", filename, WAVETABLE_WAVE_COUNT);
+        g_mapped_file_unref(rom);
+        return NULL;
+    }
+
+    table = wavetable_alloc();
+    table->rom = rom;
+
+    return table;
+}
+
+/**
+   \brief Frees a wave table.
+
+   \param table - the wave table.
+ */
+void
+wavetable_free(WaveTable *table)
+{
+    if (table->rom) {
+        g_mapped_file_unref(table->rom);
+    }
+    g_free(table->memory);
+    g_free(table);
+}
+
+/**
+   \brief Builds the band limited levels of a wave if they haven't been
+   built yet. This is safe to call from more than one thread, and must be
+   called before the wave is looked up.
+
+   \param table - the wave table.
+   \param wave - the wave number.
+ */
+void
+wavetable_prepare(WaveTable *table, gint wave)
+{
+    gfloat samples[WAVETABLE_LENGTH];
+
+    if (g_once_init_enter(&table->ready[wave])) {
+        if (table->rom) {
+            build_rom(table, wave, samples);
+        } else {
+            build_recipe(table, wave, samples);
+        }
+        build_levels(table, wave, samples);
+        g_once_init_leave(&table->ready[wave], 1);
+    }
+}
+
+/**
+   \brief Returns the level of a wave with no harmonics above the Nyquist
+   frequency when it is played at a given rate.
+
+   \param table - the wave table.
+   \param wave - the wave number, which must have been prepared.
+   \param increment - the number of cycles per sample.
+   \return the samples of the level, followed by a guard sample equal to
+   the first.
+ */
+const gfloat *
+wavetable_lookup(const WaveTable *table, gint wave, gfloat increment)
+{
+    gint level;
+
+    /* level n holds harmonics up to 128 / 2^n, so the exponent is the level */
+    frexpf(increment * WAVETABLE_LENGTH, &level);
+    level = CLAMP(level, 0, WAVETABLE_LEVELS - 1);
+
+    return table->samples + (wave * WAVETABLE_LEVELS + level) * WAVETABLE_STRIDE;
+}
+
+static WaveTable *
+wavetable_alloc(void)
+{
+    WaveTable *table;
+    gint i;
+
+    table = g_new0(WaveTable, 1);
+
+    /* the levels are stored contiguously, starting on a cache line */
+    table->memory = g_malloc((WAVETABLE_WAVE_COUNT * WAVETABLE_LEVELS * WAVETABLE_STRIDE + 16) * sizeof(gfloat));
+    table->samples = (gfloat *) (((guintptr) table->memory + 63) & ~(guintptr) 63);
+
+    for (i = 0; i < WAVETABLE_LENGTH; ++i) {
+        table->sines[i] = sinf(2.0f * G_PI * i / WAVETABLE_LENGTH);
+    }
+
+    return table;
+}
+
+static void
+build_recipe(const WaveTable *table, gint wave, gfloat *samples)
+{
+    const WaveRecipe *recipe = &wave_recipes[wave];
+    gfloat amplitude;
+    guint32 seed;
+    gint i, n;
+
+    memset(samples, 0, WAVETABLE_LENGTH * sizeof(gfloat));
+
+    if (recipe->shape == SHAPE_NOISE) {
+        seed = wave + 1;
+        for (i = 0; i < WAVETABLE_LENGTH; ++i) {
+            seed = seed * 1664525 + 1013904223;
+            samples[i] = (seed >> 8) / 8388608.0f - 1.0f;
+        }
+        return;
+    }
+
+    for (n = 1; n < WAVETABLE_LENGTH / 2; ++n) {
+        switch (recipe->shape) {
+        case SHAPE_SAWTOOTH:
+            amplitude = 1.0f / n;
+            break;
+        case SHAPE_SQUARE:
+            amplitude = n % 2 ? 1.0f / n : 0;
+            break;
+        case SHAPE_PULSE:
+            amplitude = sinf(G_PI * n * 0.25f) / n;
+            break;
+        case SHAPE_TRIANGLE:
+            amplitude = n % 2 ? ((n / 2) % 2 ? -1.0f : 1.0f) / (n * n) : 0;
+            break;
+        case SHAPE_SINE:
+            amplitude = n == 1 ? 1.0f : 0;
+            break;
+        default:
+            amplitude = n <= 32 && recipe->partials & H(n) ? 1.0f / n : 0;
+            break;
+        }
+        if (amplitude != 0) {
+            for (i = 0; i < WAVETABLE_LENGTH; ++i) {
+                samples[i] += amplitude * table->sines[(n * i) % WAVETABLE_LENGTH];
+            }
+        }
+    }
+}
+
+static void
+build_rom(const WaveTable *table, gint wave, gfloat *samples)
+{
+    const guchar *page;
+    gint i;
+
+    page = (const guchar *) g_mapped_file_get_contents(table->rom) + wave * WAVETABLE_LENGTH;
+
+    /* zero marks the end of a wave for the sound chip, so treat it as silence */
+    for (i = 0; i < WAVETABLE_LENGTH; ++i) {
+        samples[i] = page[i] ? (page[i] - ROM_ZERO) / 127.0f : 0;
+    }
+}
+
+/*
+ * Removes any offset from a wave and normalises it, then builds each level
+ * by summing the harmonics below its limit.
+ */
+static void
+build_levels(WaveTable *table, gint wave, gfloat *samples)
+{
+    gfloat re[WAVETABLE_LENGTH / 2], im[WAVETABLE_LENGTH / 2];
+    gfloat *level, mean, peak;
+    gint i, n, l, limit;
+
+    mean = 0;
+    for (i = 0; i < WAVETABLE_LENGTH; ++i) {
+        mean += samples[i];
+    }
+    mean /= WAVETABLE_LENGTH;
+
+    peak = 0;
+    for (i = 0; i < WAVETABLE_LENGTH; ++i) {
+        samples[i] -= mean;
+        peak = MAX(peak, fabsf(samples[i]));
+    }
+    if (peak == 0) {
+        peak = 1;
+    }
+
+    /* the first level is the wave itself */
+    level = table->samples + wave * WAVETABLE_LEVELS * WAVETABLE_STRIDE;
+    for (i = 0; i < WAVETABLE_LENGTH; ++i) {
+        level[i] = samples[i] / peak;
+    }
+    level[WAVETABLE_LENGTH] = level[0];
+
+    for (n = 1; n < WAVETABLE_LENGTH / 2; ++n) {
+        re[n] = 0;
+        im[n] = 0;
+        for (i = 0; i < WAVETABLE_LENGTH; ++i) {
+            re[n] += samples[i] * table->sines[(n * i + COSINE) % WAVETABLE_LENGTH];
+            im[n] += samples[i] * table->sines[(n * i) % WAVETABLE_LENGTH];
+        }
+        re[n] *= 2.0f / (WAVETABLE_LENGTH * peak);
+        im[n] *= 2.0f / (WAVETABLE_LENGTH * peak);
+    }
+
+    for (l = 1; l < WAVETABLE_LEVELS; ++l) {
+        level = table->samples + (wave * WAVETABLE_LEVELS + l) * WAVETABLE_STRIDE;
+        limit = (WAVETABLE_LENGTH / 2) >> l;
+        for (i = 0; i < WAVETABLE_LENGTH; ++i) {
+            level[i] = 0;
+            for (n = 1; n <= limit; ++n) {
+                level[i] += re[n] * table->sines[(n * i + COSINE) % WAVETABLE_LENGTH]
+                    + im[n] * table->sines[(n * i) % WAVETABLE_LENGTH];
+            }
+        }
+        level[WAVETABLE_LENGTH] = level[0];
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef WAVETABLE_H
+#define WAVETABLE_H
+
+#define WAVETABLE_WAVE_COUNT 75
+
+/* Samples in a single cycle wave */
+#define WAVETABLE_LENGTH 256
+
+/* Band limited copies of each wave, one per octave */
+#define WAVETABLE_LEVELS 8
+
+/* Samples per level, padded to a whole number of cache lines */
+#define WAVETABLE_STRIDE 272
+
+typedef struct {
+    gpointer memory;
+    gfloat *samples;
+    GMappedFile *rom;
+    gsize ready[WAVETABLE_WAVE_COUNT];
+    gfloat sines[WAVETABLE_LENGTH];
+} WaveTable;
+
+WaveTable *wavetable_new(void);
+WaveTable *wavetable_load(const gchar *, GError **);
+void wavetable_free(WaveTable *);
+void wavetable_prepare(WaveTable *, gint);
+const gfloat *wavetable_lookup(const WaveTable *, gint, gfloat);
+
+#endif /* !WAVETABLE_H */
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2021 Chris Wareham <chris@chriswareham.net>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+#include "wavfile.h"
+
+#define WAVFILE_CHANNELS 2
+#define WAVFILE_BYTES_PER_FRAME (WAVFILE_CHANNELS * 2)
+#define WAVFILE_HEADER_SIZE 44
+#define WAVFILE_BUFFER_FRAMES 512
+
+static void put_uint16(guchar *, guint);
+static void put_uint32(guchar *, guint);
+static gboolean write_header(WavFile *);
+
+/**
+   \brief Creates a stereo 16 bit WAV file that frames are streamed to.
+
+   \param filename - the name of the file.
+   \param rate - the sample rate.
+   \return the WAV file, or NULL if the file could not be created, with
+   errno set.
+ */
+WavFile *
+wavfile_open(const gchar *filename, guint rate)
+{
+    WavFile *wav;
+    gint saved_errno;
+
+    wav = g_new0(WavFile, 1);
+    wav->rate = rate;
+
+    if (!(wav->fp = fopen(filename, "wb"))) {
+        g_free(wav);
+        return NULL;
+    }
+
+    /* the sizes are filled in when the file is closed */
+    if (!write_header(wav)) {
+        saved_errno = errno;
+        fclose(wav->fp);
+        g_free(wav);
+        errno = saved_errno;
+        return NULL;
+    }
+
+    return wav;
+}
+
+/**
+   \brief Appends frames to a WAV file, clipping samples to the range -1 to 1.
+
+   \param wav - the WAV file.
+   \param left - the samples of the left channel.
+   \param right - the samples of the right channel.
+   \param frames - the number of frames.
+   \return whether the frames were written, with errno set if they were not.
+ */
+gboolean
+wavfile_write(WavFile *wav, const gfloat *left, const gfloat *right, gint frames)
+{
+    guchar buf[WAVFILE_BUFFER_FRAMES * WAVFILE_BYTES_PER_FRAME];
+    gint i, n;
+    gfloat l, r;
+
+    while (frames > 0) {
+        n = MIN(frames, WAVFILE_BUFFER_FRAMES);
+
+        for (i = 0; i < n; ++i) {
+            l = CLAMP(left[i], -1.0f, 1.0f);
+            r = CLAMP(right[i], -1.0f, 1.0f);
+            put_uint16(buf + i * WAVFILE_BYTES_PER_FRAME, (guint16) (gint16) (l * 32767.0f));
+            put_uint16(buf + i * WAVFILE_BYTES_PER_FRAME + 2, (guint16) (gint16) (r * 32767.0f));
+        }
+
+        if (fwrite(buf, WAVFILE_BYTES_PER_FRAME, n, wav->fp) != (size_t) n) {
+            return FALSE;
+        }
+
+        wav->frames += n;
+        left += n;
+        right += n;
+        frames -= n;
+    }
+
+    return TRUE;
+}
+
+/**
+   \brief Completes the header of a WAV file and closes it.
+
+   \param wav - the WAV file, which is freed.
+   \return whether the file was completed, with errno set from the first
+   failure if it was not.
+ */
+gboolean
+wavfile_close(WavFile *wav)
+{
+    gboolean status;
+    gint saved_errno = 0;
+
+    if (!(status = fseek(wav->fp, 0, SEEK_SET) == 0 && write_header(wav))) {
+        saved_errno = errno;
+    }
+
+    if (fclose(wav->fp) != 0 && status) {
+        status = FALSE;
+        saved_errno = errno;
+    }
+
+    g_free(wav);
+
+    if (!status) {
+        errno = saved_errno;
+    }
+
+    return status;
+}
+
+static void
+put_uint16(guchar *buf, guint value)
+{
+    buf[0] = value & 0xff;
+    buf[1] = (value >> 8) & 0xff;
+}
+
+static void
+put_uint32(guchar *buf, guint value)
+{
+    buf[0] = value & 0xff;
+    buf[1] = (value >> 8) & 0xff;
+    buf[2] = (value >> 16) & 0xff;
+    buf[3] = (value >> 24) & 0xff;
+}
+
+static gboolean
+write_header(WavFile *wav)
+{
+    guchar header[WAVFILE_HEADER_SIZE];
+    guint size;
+
+    size = wav->frames * WAVFILE_BYTES_PER_FRAME;
+
+    memcpy(header, "RIFF", 4);
+    put_uint32(header + 4, WAVFILE_HEADER_SIZE - 8 + size);
+    memcpy(header + 8, "WAVE", 4);
+
+    memcpy(header + 12, "fmt ", 4);
+    put_uint32(header + 16, 16);
+    put_uint16(header + 20, 1);
+    put_uint16(header + 22, WAVFILE_CHANNELS);
+    put_uint32(header + 24, wav->rate);
+    put_uint32(header + 28, wav->rate * WAVFILE_BYTES_PER_FRAME);
+    put_uint16(header + 32, WAVFILE_BYTES_PER_FRAME);
+    put_uint16(header + 34, 16);
+
+    memcpy(header + 36, "data", 4);
+    put_uint32(header + 40, size);
+
+    return fwrite(header, WAVFILE_HEADER_SIZE, 1, wav->fp) == 1;
+}
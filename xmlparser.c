@@ -23,6 +23,8 @@
 #include <gtk/gtk.h>
 
 #include "main.h"
+#include "patch.h"
+#include "parameters.h"
 #include "xmlparser.h"
 
 typedef enum {
@@ -83,7 +85,7 @@ xmlparser_read(const gchar *filename, GError **error)
     }
 
     data.state = STATE_START;
-    data.patch = g_malloc0(sizeof(Patch));
+    data.patch = patch_new();
 
     parser.start_element = start_element;
     parser.end_element = end_element;
@@ -98,13 +100,7 @@ xmlparser_read(const gchar *filename, GError **error)
         status = g_markup_parse_context_parse(context, buf, strlen(buf), error);
         g_free(buf);
         if (!status) {
-            if (data.patch->name) {
-                g_free(data.patch->name);
-            }
-            if (data.patch->type) {
-                g_free(data.patch->type);
-            }
-            g_free(data.patch);
+            patch_free(data.patch);
             data.patch = NULL;
             break;
         }
@@ -140,7 +136,7 @@ start_element(GMarkupParseContext *context, const gchar *element_name, const gch
         } else if (strcmp(element_name, "param") == 0) {
             pd->state = STATE_PARAM;
             id = -1;
-            value = -1;
+            value = G_MININT;
             for (i = 0; attribute_names[i] && attribute_values[i]; i++) {
                 if (strcmp(attribute_names[i], "id") == 0) {
                     id = strtol(attribute_values[i], &ptr, 10);
@@ -150,17 +146,26 @@ start_element(GMarkupParseContext *context, const gchar *element_name, const gch
                 } else if (strcmp(attribute_names[i], "value") == 0) {
                     value = strtol(attribute_values[i], &ptr, 10);
                     if (attribute_values[i][0] == '\0' || *ptr != '\0') {
-                        value = -1;
+                        value = G_MININT;
                     }
                 } else {
                     g_set_error(error, G_MARKUP_ERROR, G_MARKUP_ERROR_UNKNOWN_ATTRIBUTE, "unknown attribute '%s'", element_name);
                     break;
                 }
             }
-            if (id < 0 || id > 35 || value < 0 || value > 127) {
+            /* signed values are written as the byte held in the patch, but may be negative */
+            if (id < 0 || id >= PARAMETER_COUNT || value < G_MININT8 || value > G_MAXUINT8) {
                 g_set_error(error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT, "bad parameter value");
             } else {
-                pd->patch->parameters[id] = value;
+                /* only signed values may be written as bytes, so only they are converted before checking */
+                if (parameter_descriptors[id].kind == DESCRIPTOR_SIGNED) {
+                    value = parameters_decode(id, (guchar) value);
+                }
+                if (value < parameter_descriptors[id].minimum || value > parameter_descriptors[id].maximum) {
+                    /* older editors wrote some values outside the ranges the dialogs show */
+                    fprintf(stderr, "Parameter '%s' value %d out of range\n", parameter_descriptors[id].name, value);
+                }
+                pd->patch->parameters[id] = parameters_clamp(id, value);
             }
         } else {
             g_set_error(error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT, "invalid element '%s'", element_name);
@@ -211,12 +216,10 @@ text(GMarkupParseContext *context, const gchar *text, gsize len, gpointer data,
 
     switch (pd->state) {
     case STATE_NAME:
-        pd->patch->name = g_malloc0(len + 1);
-        memcpy(pd->patch->name, text, len);
+        patch_set_name(pd->patch, text, len);
         break;
     case STATE_TYPE:
-        pd->patch->type = g_malloc0(len + 1);
-        memcpy(pd->patch->type, text, len);
+        patch_set_type(pd->patch, text, len);
         break;
     case STATE_SQ80:
         if (len) {